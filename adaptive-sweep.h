@@ -0,0 +1,157 @@
+#ifndef ADAPTIVE_SWEEP_H
+#define ADAPTIVE_SWEEP_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+#include "replication-stats.h"
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//parameters of an adaptive packet size sweep
+struct AdaptiveSweepOptions
+{
+	uint32_t minPacketSize;   //first packet size of the sweep
+	uint32_t maxPacketSize;   //last packet size of the sweep
+	uint32_t coarsePoints;    //packet sizes of the initial grid, spread evenly in log scale
+	uint32_t budget;          //total number of simulations (packet sizes times runs) allowed
+	uint32_t minGap;          //intervals narrower than this many bytes are not split
+	double threshold;         //score of an interval above which it is split
+
+	AdaptiveSweepOptions ()
+	: minPacketSize (40),
+	maxPacketSize (1500),
+	coarsePoints (6),
+	budget (40),
+	minGap (4),
+	threshold (0.05)
+	{
+	}
+};
+
+//simulate a batch of jobs, e.g. RunSweep or RunCachedSweep bound to a program
+typedef std::function<std::vector<SweepPointResult> (const std::vector<SweepJob>&)> SweepBatchFunction;
+
+//Adaptive packet size sweep: simulate a coarse log spaced grid, then repeatedly split the
+//intervals between neighbouring packet sizes with the highest score at their midpoint, where the
+//score of an interval is the largest of
+//- the change of the mean throughput, relative to the throughput range seen so far
+//- the change of the mean fairness, relative to the fairness range seen so far (at least 0.1)
+//- the relative 95% confidence interval width of the throughput at either end (runs > 1)
+//Every round splits as many intervals above the threshold as the remaining budget allows, so
+//the points of a round are still simulated in parallel. Returns all results ordered by packet
+//size and run.
+inline std::vector<SweepPointResult>
+RunAdaptiveSweep (const AdaptiveSweepOptions& options, uint32_t runs, const SweepBatchFunction& simulateBatch)
+{
+	runs = std::max<uint32_t> (runs, 1);
+	std::map<uint32_t, std::vector<SweepPointResult> > points;
+	uint32_t used = 0;
+
+	//log spaced grid, so the small sizes where the header overhead dominates get more points
+	std::vector<uint32_t> sizes;
+	uint32_t coarse = std::max<uint32_t> (options.coarsePoints, 2);
+	for (uint32_t i = 0; i < coarse; i++)
+	{
+		double fraction = static_cast<double> (i) / (coarse - 1);
+		uint32_t size = static_cast<uint32_t> (std::round (options.minPacketSize * std::pow (static_cast<double> (options.maxPacketSize) / options.minPacketSize, fraction)));
+		if (sizes.empty () || size != sizes.back ())
+		{
+			sizes.push_back (size);
+		}
+	}
+
+	uint32_t round = 0;
+	while (!sizes.empty () && used + sizes.size () * runs <= options.budget)
+	{
+		std::vector<SweepJob> jobs = MakeSweepJobs (sizes, runs);
+		for (const SweepPointResult& result : simulateBatch (jobs))
+		{
+			points[result.packetSize].push_back (result);
+		}
+		used += jobs.size ();
+		std::cout << "Adaptive sweep round " << round++ << " : " << sizes.size () << " packet size(s), "
+		          << used << "/" << options.budget << " simulations\n";
+
+		//mean values of every packet size simulated so far
+		std::vector<uint32_t> known;
+		std::vector<ReplicationSummary> summaries;
+		for (const auto& entry : points)
+		{
+			std::vector<ReplicationSummary> summary = SummarizeReplications (entry.second);
+			if (!summary.empty ())
+			{
+				known.push_back (entry.first);
+				summaries.push_back (summary[0]);
+			}
+		}
+		if (known.size () < 2)
+		{
+			break;
+		}
+		double minThroughput = summaries[0].throughput.mean, maxThroughput = minThroughput;
+		double minFairness = summaries[0].fairness.mean, maxFairness = minFairness;
+		for (const ReplicationSummary& summary : summaries)
+		{
+			minThroughput = std::min (minThroughput, summary.throughput.mean);
+			maxThroughput = std::max (maxThroughput, summary.throughput.mean);
+			minFairness = std::min (minFairness, summary.fairness.mean);
+			maxFairness = std::max (maxFairness, summary.fairness.mean);
+		}
+		double throughputRange = std::max (maxThroughput - minThroughput, 1e-9);
+		double fairnessRange = std::max (maxFairness - minFairness, 0.1);
+
+		//score every interval wide enough to be split and split the best ones first
+		std::vector<std::pair<double, uint32_t> > candidates;
+		for (size_t i = 0; i + 1 < known.size (); i++)
+		{
+			if (known[i + 1] - known[i] < 2 * std::max<uint32_t> (options.minGap, 1))
+			{
+				continue;
+			}
+			const ReplicationSummary& a = summaries[i];
+			const ReplicationSummary& b = summaries[i + 1];
+			double score = std::fabs (b.throughput.mean - a.throughput.mean) / throughputRange;
+			score = std::max (score, std::fabs (b.fairness.mean - a.fairness.mean) / fairnessRange);
+			if (runs > 1)
+			{
+				score = std::max (score, a.throughput.mean > 0 ? a.throughput.ciHalfWidth / a.throughput.mean : 0.0);
+				score = std::max (score, b.throughput.mean > 0 ? b.throughput.ciHalfWidth / b.throughput.mean : 0.0);
+			}
+			if (score > options.threshold)
+			{
+				candidates.push_back (std::make_pair (score, (known[i] + known[i + 1]) / 2));
+			}
+		}
+		std::sort (candidates.rbegin (), candidates.rend ());
+		sizes.clear ();
+		for (const auto& candidate : candidates)
+		{
+			if (used + (sizes.size () + 1) * runs > options.budget)
+			{
+				break;
+			}
+			sizes.push_back (candidate.second);
+		}
+		std::sort (sizes.begin (), sizes.end ());
+	}
+	std::cout << "\n";
+
+	std::vector<SweepPointResult> results;
+	for (const auto& entry : points)
+	{
+		results.insert (results.end (), entry.second.begin (), entry.second.end ());
+	}
+	return results;
+}
+
+} // namespace ns3
+
+#endif /* ADAPTIVE_SWEEP_H */
@@ -0,0 +1,70 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+//Counts the heap allocations of the whole program (including the ns-3 libraries) by
+//replacing the global operator new. The replacement functions are not inline, so this
+//header must be included by exactly one translation unit, the file containing main().
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+namespace ns3
+{
+
+//number of calls to operator new since the program started
+static std::atomic<uint64_t> g_heapAllocations (0);
+
+//return the number of heap allocations made so far
+inline uint64_t
+GetHeapAllocations (void)
+{
+	return g_heapAllocations.load (std::memory_order_relaxed);
+}
+
+} // namespace ns3
+
+void*
+operator new (std::size_t size)
+{
+	ns3::g_heapAllocations.fetch_add (1, std::memory_order_relaxed);
+	void* p = std::malloc (size == 0 ? 1 : size);
+	if (p == nullptr)
+	{
+		throw std::bad_alloc ();
+	}
+	return p;
+}
+
+void*
+operator new[] (std::size_t size)
+{
+	return operator new (size);
+}
+
+void
+operator delete (void* p) noexcept
+{
+	std::free (p);
+}
+
+void
+operator delete[] (void* p) noexcept
+{
+	std::free (p);
+}
+
+void
+operator delete (void* p, std::size_t) noexcept
+{
+	std::free (p);
+}
+
+void
+operator delete[] (void* p, std::size_t) noexcept
+{
+	std::free (p);
+}
+
+#endif /* ALLOC_COUNTER_H */
@@ -0,0 +1,356 @@
+#ifndef ANIMATION_STREAM_H
+#define ANIMATION_STREAM_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/wifi-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+//NetAnim trace for long runs. AnimationInterface keeps the metadata of every packet, polls the
+//node positions and writes every packet of every device; this writes the nodes, the links and
+//only the packets chosen:
+//- every N-th packet sent over the devices added
+//- and only the packets sent within the time windows added, if any
+//as <p> elements without meta-info. The xml is appended to a buffer of bounded size, written
+//out when full, and piped through gzip when the file name ends in ".gz" (gunzip it before
+//opening it in NetAnim). A point-to-point packet is resolved to the peer of the device with the
+//delay and data rate of the link, a wifi frame to the owner of its receiver address with the
+//duration of the PPDU and no propagation delay; group addressed frames (beacons) are skipped.
+class AnimationStream
+{
+	public:
+		//bufferBytes of xml are held before they are written out
+		AnimationStream (const std::string& fileName, uint32_t bufferBytes);
+		~AnimationStream ();
+
+		//write every everyN-th packet, 1 writes all of them
+		void SetDecimation (uint32_t everyN);
+
+		//only write the packets sent between start and stop, call before the simulation starts
+		void AddWindow (Time start, Time stop);
+
+		//place a node, at its mobility model position if it has one
+		void AddNode (Ptr<Node> node, double x, double y);
+		void AddNode (Ptr<Node> node);
+
+		//animate what the point-to-point and wifi devices send, other devices are ignored;
+		//add the nodes of the devices first
+		void AddDevices (const NetDeviceContainer& devices);
+
+		//write what is left in the buffer and close the file, call after Simulator::Run()
+		void Finish (void);
+
+		//packets seen and written, bytes of xml written before compression
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+	private:
+		static void NotifyPointToPoint (AnimationStream* stream, uint32_t from, uint32_t to, Time delay, DataRate rate, Ptr<const Packet> packet);
+		static void NotifyWifi (AnimationStream* stream, uint32_t from, WifiPhyBand band, WifiConstPsduMap psdus, WifiTxVector txVector, double txPowerW);
+
+		void AddPointToPoint (Ptr<PointToPointNetDevice> device);
+		void AddWifi (Ptr<WifiNetDevice> device);
+		bool IsWritten (void);
+		void WritePacket (uint32_t from, uint32_t to, Time firstTx, Time lastTx, Time delay);
+		void Write (const char* data, size_t length);
+		void Flush (void);
+
+		std::FILE* m_file;
+		bool m_pipe;
+		std::string m_buffer;
+		uint32_t m_bufferBytes;
+
+		uint32_t m_everyN;
+		uint32_t m_countdown;
+		std::vector<std::pair<Time, Time> > m_windows;
+		uint32_t m_window;      //first window that did not end yet
+
+		std::map<Mac48Address, uint32_t> m_macs;    //node owning every wifi address added
+		std::vector<std::pair<uint32_t, uint32_t> > m_links;
+
+		uint64_t m_seen;
+		uint64_t m_written;
+		uint64_t m_bytes;
+};
+
+inline
+AnimationStream::AnimationStream (const std::string& fileName, uint32_t bufferBytes)
+: m_file (nullptr),
+m_pipe (fileName.size () > 3 && fileName.compare (fileName.size () - 3, 3, ".gz") == 0),
+m_bufferBytes (std::max<uint32_t> (bufferBytes, 256)),
+m_everyN (1),
+m_countdown (1),
+m_window (0),
+m_seen (0),
+m_written (0),
+m_bytes (0)
+{
+	if (m_pipe)
+	{
+		//single quote the name for the shell, a quote in it is closed, escaped and reopened
+		std::string command = "gzip -c > '";
+		for (char c : fileName)
+		{
+			if (c == '\'')
+			{
+				command += "'\\''";
+			}
+			else
+			{
+				command += c;
+			}
+		}
+		command += "'";
+		m_file = popen (command.c_str (), "w");
+	}
+	else
+	{
+		m_file = std::fopen (fileName.c_str (), "w");
+	}
+	if (m_file == nullptr)
+	{
+		NS_FATAL_ERROR ("Cannot open animation trace " << fileName);
+	}
+	m_buffer.reserve (m_bufferBytes + 256);
+	const char header[] = "<anim ver=\"netanim-3.108\" filetype=\"animation\" >\n";
+	Write (header, sizeof (header) - 1);
+}
+
+inline
+AnimationStream::~AnimationStream ()
+{
+	Finish ();
+}
+
+inline void
+AnimationStream::SetDecimation (uint32_t everyN)
+{
+	m_everyN = std::max<uint32_t> (everyN, 1);
+	m_countdown = 1;
+}
+
+inline void
+AnimationStream::AddWindow (Time start, Time stop)
+{
+	m_windows.push_back (std::make_pair (start, stop));
+	std::sort (m_windows.begin (), m_windows.end ());
+}
+
+inline void
+AnimationStream::AddNode (Ptr<Node> node, double x, double y)
+{
+	char line[128];
+	int length = std::snprintf (line, sizeof (line), "<node id=\"%u\" sysId=\"0\" locX=\"%g\" locY=\"%g\" />\n",
+	                            node->GetId (), x, y);
+	Write (line, length);
+}
+
+inline void
+AnimationStream::AddNode (Ptr<Node> node)
+{
+	Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+	Vector position = mobility != nullptr ? mobility->GetPosition () : Vector ();
+	AddNode (node, position.x, position.y);
+}
+
+inline void
+AnimationStream::AddDevices (const NetDeviceContainer& devices)
+{
+	for (uint32_t i = 0; i < devices.GetN (); i++)
+	{
+		Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice> (devices.Get (i));
+		Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice> (devices.Get (i));
+		if (p2p != nullptr)
+		{
+			AddPointToPoint (p2p);
+		}
+		else if (wifi != nullptr)
+		{
+			AddWifi (wifi);
+		}
+	}
+}
+
+inline void
+AnimationStream::AddPointToPoint (Ptr<PointToPointNetDevice> device)
+{
+	Ptr<Channel> channel = device->GetChannel ();
+	Ptr<NetDevice> peer = channel->GetDevice (channel->GetDevice (0) == device ? 1 : 0);
+	uint32_t from = device->GetNode ()->GetId ();
+	uint32_t to = peer->GetNode ()->GetId ();
+
+	TimeValue delay;
+	channel->GetAttribute ("Delay", delay);
+	DataRateValue rate;
+	device->GetAttribute ("DataRate", rate);
+	device->TraceConnectWithoutContext ("PhyTxBegin", MakeBoundCallback (&AnimationStream::NotifyPointToPoint, this, from, to, delay.Get (), rate.Get ()));
+
+	//both devices of a link are usually added, write the link once
+	std::pair<uint32_t, uint32_t> link = std::make_pair (std::min (from, to), std::max (from, to));
+	if (std::find (m_links.begin (), m_links.end (), link) == m_links.end ())
+	{
+		m_links.push_back (link);
+		char line[128];
+		int length = std::snprintf (line, sizeof (line), "<link fromId=\"%u\" toId=\"%u\" fd=\"\" tld=\"\" ld=\"\" />\n", link.first, link.second);
+		Write (line, length);
+	}
+}
+
+inline void
+AnimationStream::AddWifi (Ptr<WifiNetDevice> device)
+{
+	uint32_t from = device->GetNode ()->GetId ();
+	m_macs[Mac48Address::ConvertFrom (device->GetAddress ())] = from;
+	Ptr<WifiPhy> phy = device->GetPhy ();
+	phy->TraceConnectWithoutContext ("PhyTxPsduBegin", MakeBoundCallback (&AnimationStream::NotifyWifi, this, from, phy->GetPhyBand ()));
+}
+
+inline bool
+AnimationStream::IsWritten (void)
+{
+	m_seen++;
+	if (m_file == nullptr)
+	{
+		return false;
+	}
+	if (!m_windows.empty ())
+	{
+		Time now = Simulator::Now ();
+		while (m_window < m_windows.size () && m_windows[m_window].second < now)
+		{
+			m_window++;
+		}
+		if (m_window == m_windows.size () || now < m_windows[m_window].first)
+		{
+			return false;
+		}
+	}
+	if (--m_countdown > 0)
+	{
+		return false;
+	}
+	m_countdown = m_everyN;
+	return true;
+}
+
+inline void
+AnimationStream::NotifyPointToPoint (AnimationStream* stream, uint32_t from, uint32_t to, Time delay, DataRate rate, Ptr<const Packet> packet)
+{
+	if (stream->IsWritten ())
+	{
+		Time now = Simulator::Now ();
+		stream->WritePacket (from, to, now, now + rate.CalculateBytesTxTime (packet->GetSize ()), delay);
+	}
+}
+
+inline void
+AnimationStream::NotifyWifi (AnimationStream* stream, uint32_t from, WifiPhyBand band, WifiConstPsduMap psdus, WifiTxVector txVector, double txPowerW)
+{
+	if (psdus.empty () || psdus.begin ()->second->GetAddr1 ().IsGroup () || !stream->IsWritten ())
+	{
+		return;
+	}
+	Time now = Simulator::Now ();
+	Time lastTx = now + WifiPhy::CalculateTxDuration (psdus, txVector, band);
+	for (const auto& psdu : psdus)
+	{
+		std::map<Mac48Address, uint32_t>::const_iterator to = stream->m_macs.find (psdu.second->GetAddr1 ());
+		if (to != stream->m_macs.end ())
+		{
+			stream->WritePacket (from, to->second, now, lastTx, Seconds (0));
+		}
+	}
+}
+
+inline void
+AnimationStream::WritePacket (uint32_t from, uint32_t to, Time firstTx, Time lastTx, Time delay)
+{
+	char line[192];
+	int length = std::snprintf (line, sizeof (line),
+	                            "<p fId=\"%u\" fbTx=\"%.9f\" lbTx=\"%.9f\" tId=\"%u\" fbRx=\"%.9f\" lbRx=\"%.9f\" />\n",
+	                            from, firstTx.GetSeconds (), lastTx.GetSeconds (), to,
+	                            (firstTx + delay).GetSeconds (), (lastTx + delay).GetSeconds ());
+	Write (line, length);
+	m_written++;
+}
+
+inline void
+AnimationStream::Write (const char* data, size_t length)
+{
+	m_buffer.append (data, length);
+	m_bytes += length;
+	if (m_buffer.size () >= m_bufferBytes)
+	{
+		Flush ();
+	}
+}
+
+inline void
+AnimationStream::Flush (void)
+{
+	std::fwrite (m_buffer.data (), 1, m_buffer.size (), m_file);
+	m_buffer.clear ();
+}
+
+inline void
+AnimationStream::Finish (void)
+{
+	if (m_file == nullptr)
+	{
+		return;
+	}
+	const char footer[] = "</anim>\n";
+	Write (footer, sizeof (footer) - 1);
+	Flush ();
+	if (m_pipe)
+	{
+		pclose (m_file);
+	}
+	else
+	{
+		std::fclose (m_file);
+	}
+	m_file = nullptr;
+}
+
+inline void
+AnimationStream::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	metrics["animPacketsSeen"] = m_seen;
+	metrics["animPacketsWritten"] = m_written;
+	metrics["animBytes"] = m_bytes;
+}
+
+//parse "start-stop[,start-stop...]" in seconds into the windows of stream
+inline void
+ParseAnimationWindows (const std::string& windows, AnimationStream& stream)
+{
+	std::istringstream input (windows);
+	std::string window;
+	while (std::getline (input, window, ','))
+	{
+		double start, stop;
+		char dash;
+		std::istringstream range (window);
+		if (!(range >> start >> dash >> stop) || dash != '-' || stop < start)
+		{
+			NS_FATAL_ERROR ("Invalid animation window " << window << ", expected start-stop in seconds");
+		}
+		stream.AddWindow (Seconds (start), Seconds (stop));
+	}
+}
+
+} // namespace ns3
+
+#endif /* ANIMATION_STREAM_H */
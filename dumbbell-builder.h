@@ -0,0 +1,334 @@
+#ifndef DUMBBELL_BUILDER_H
+#define DUMBBELL_BUILDER_H
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "routing-mode.h"
+
+namespace ns3
+{
+
+//Builds a dumbbell of N sender hosts behind router r1 and M receiver hosts behind router r2
+//in bulk: nodes, links, addresses, routes, sinks and one source application per flow.
+//Flow i runs from sender i / flowsPerSender to receiver i % M with congestion control
+//mix[i % mix size]. The socket type is set directly on the TcpL4Protocol of the sender
+//instead of through a Config path, and by default every host only gets a static default
+//route to its router, so building stays linear in the number of flows. For a distributed
+//simulation the receiver side is placed on rank 0 and the sender side on rank 1, so the
+//bottleneck is the only link between ranks; applications are only installed on the nodes of
+//the local rank.
+class DumbbellBuilder
+{
+	public:
+		//create the source application of a flow sending over socket to sink
+		typedef std::function<Ptr<Application> (Ptr<Socket> socket, const Address& sink, uint32_t flow)> SourceFactory;
+
+		DumbbellBuilder ();
+
+		void SetSenders (uint32_t senders);
+		void SetReceivers (uint32_t receivers);
+		void SetFlowsPerSender (uint32_t flows);
+
+		//congestion control type names (e.g. "ns3::TcpVegas") assigned to the flows round robin
+		void SetCongestionControlMix (const std::vector<std::string>& typeNames);
+
+		void SetAccessLink (const std::string& dataRate, const std::string& delay);
+		void SetBottleneckLink (const std::string& dataRate, const std::string& delay, uint32_t queueBytes);
+
+		//how the routes are set up, static by default
+		void SetRoutingMode (RoutingMode mode);
+
+		//rank of this process and number of ranks of a distributed simulation, at most 2 since
+		//the topology is only cut at the bottleneck
+		void SetRanks (uint32_t rank, uint32_t nRanks);
+
+		//create the nodes, links, internet stacks, addresses and routes
+		void Build (void);
+
+		//install a packet sink on every local receiver
+		ApplicationContainer InstallSinks (uint16_t port, Time start, Time stop);
+
+		//create the socket and the source application of every flow starting on a local sender,
+		//call after InstallSinks
+		ApplicationContainer InstallSources (const SourceFactory& factory, Time start, Time stop);
+
+		uint32_t GetFlowCount (void) const;
+		bool IsLocal (Ptr<Node> node) const;
+		const NodeContainer& GetSenders (void) const;
+		const NodeContainer& GetReceivers (void) const;
+		Ipv4Address GetReceiverAddress (uint32_t i) const;
+		Ptr<Node> GetLeftRouter (void) const;
+		Ptr<Node> GetRightRouter (void) const;
+
+		//device of r1 (0) and r2 (1) on the bottleneck link
+		Ptr<NetDevice> GetBottleneckDevice (uint32_t i) const;
+
+		//create a tcp socket on node using the given congestion control algorithm
+		static Ptr<Socket> CreateTcpSocket (Ptr<Node> node, TypeId congestionControl);
+
+	private:
+		uint32_t m_senders;
+		uint32_t m_receivers;
+		uint32_t m_flowsPerSender;
+		std::vector<TypeId> m_congestionControl;
+		std::string m_accessRate;
+		std::string m_accessDelay;
+		std::string m_bottleneckRate;
+		std::string m_bottleneckDelay;
+		uint32_t m_queueBytes;
+		RoutingMode m_routing;
+		uint32_t m_rank;
+		uint32_t m_nRanks;
+
+		NodeContainer m_senderNodes;
+		NodeContainer m_receiverNodes;
+		NodeContainer m_routers;
+		NetDeviceContainer m_bottleneck;
+		std::vector<Ipv4Address> m_receiverAddresses;
+		uint16_t m_sinkPort;
+};
+
+inline
+DumbbellBuilder::DumbbellBuilder ()
+: m_senders (1),
+m_receivers (1),
+m_flowsPerSender (1),
+m_congestionControl (1, TypeId::LookupByName ("ns3::TcpNewReno")),
+m_accessRate ("100Mbps"),
+m_accessDelay ("20ms"),
+m_bottleneckRate ("10Mbps"),
+m_bottleneckDelay ("50ms"),
+m_queueBytes (6250),
+m_routing (ROUTING_STATIC),
+m_rank (0),
+m_nRanks (1),
+m_sinkPort (0)
+{
+}
+
+inline void
+DumbbellBuilder::SetSenders (uint32_t senders)
+{
+	m_senders = senders;
+}
+
+inline void
+DumbbellBuilder::SetReceivers (uint32_t receivers)
+{
+	m_receivers = receivers < 1 ? 1 : receivers;
+}
+
+inline void
+DumbbellBuilder::SetFlowsPerSender (uint32_t flows)
+{
+	m_flowsPerSender = flows;
+}
+
+inline void
+DumbbellBuilder::SetCongestionControlMix (const std::vector<std::string>& typeNames)
+{
+	m_congestionControl.clear ();
+	for (const std::string& name : typeNames)
+	{
+		m_congestionControl.push_back (TypeId::LookupByName (name));
+	}
+	if (m_congestionControl.empty ())
+	{
+		m_congestionControl.push_back (TypeId::LookupByName ("ns3::TcpNewReno"));
+	}
+}
+
+inline void
+DumbbellBuilder::SetAccessLink (const std::string& dataRate, const std::string& delay)
+{
+	m_accessRate = dataRate;
+	m_accessDelay = delay;
+}
+
+inline void
+DumbbellBuilder::SetBottleneckLink (const std::string& dataRate, const std::string& delay, uint32_t queueBytes)
+{
+	m_bottleneckRate = dataRate;
+	m_bottleneckDelay = delay;
+	m_queueBytes = queueBytes;
+}
+
+inline void
+DumbbellBuilder::SetRanks (uint32_t rank, uint32_t nRanks)
+{
+	NS_ABORT_MSG_IF (nRanks > 2, "The dumbbell is split at the bottleneck into 2 ranks, run it with mpirun -np 2");
+	m_rank = rank;
+	m_nRanks = nRanks < 1 ? 1 : nRanks;
+}
+
+inline void
+DumbbellBuilder::SetRoutingMode (RoutingMode mode)
+{
+	m_routing = mode;
+}
+
+inline void
+DumbbellBuilder::Build (void)
+{
+	//receiver side on rank 0, r1 and the senders on rank 1, so the access links stay local and
+	//the bottleneck delay is the lookahead
+	uint32_t senderSide = m_nRanks > 1 ? 1 : 0;
+	m_routers.Create (1, senderSide);
+	m_routers.Create (1, 0);
+	m_receiverNodes.Create (m_receivers, 0);
+	m_senderNodes.Create (m_senders, senderSide);
+
+	PointToPointHelper accessLink;
+	accessLink.SetDeviceAttribute ("DataRate", StringValue (m_accessRate));
+	accessLink.SetChannelAttribute ("Delay", StringValue (m_accessDelay));
+
+	PointToPointHelper bottleneckLink;
+	bottleneckLink.SetDeviceAttribute ("DataRate", StringValue (m_bottleneckRate));
+	bottleneckLink.SetChannelAttribute ("Delay", StringValue (m_bottleneckDelay));
+	bottleneckLink.SetQueue ("ns3::DropTailQueue", "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::BYTES, m_queueBytes)));
+
+	InternetStackHelper stack;
+	SetStackRouting (stack, m_routing);
+	stack.Install (m_routers);
+	stack.Install (m_receiverNodes);
+	stack.Install (m_senderNodes);
+
+	//bottleneck first, so it is the first interface of both routers
+	Ipv4AddressHelper address;
+	address.SetBase ("10.1.2.0", "255.255.255.0");
+	m_bottleneck = bottleneckLink.Install (m_routers.Get (0), m_routers.Get (1));
+	Ipv4InterfaceContainer bottleneckInterfaces = address.Assign (m_bottleneck);
+	AddDefaultRoute (m_routing, m_bottleneck.Get (0), bottleneckInterfaces.GetAddress (1));
+	AddDefaultRoute (m_routing, m_bottleneck.Get (1), bottleneckInterfaces.GetAddress (0));
+
+	//one /30 subnet per host, the routers reach their hosts through the connected routes
+	address.SetBase ("172.16.0.0", "255.255.255.252");
+	for (uint32_t i = 0; i < m_senderNodes.GetN (); i++)
+	{
+		NetDeviceContainer link = accessLink.Install (m_senderNodes.Get (i), m_routers.Get (0));
+		Ipv4InterfaceContainer interfaces = address.Assign (link);
+		AddDefaultRoute (m_routing, link.Get (0), interfaces.GetAddress (1));
+		address.NewNetwork ();
+	}
+
+	address.SetBase ("192.168.0.0", "255.255.255.252");
+	m_receiverAddresses.clear ();
+	m_receiverAddresses.reserve (m_receiverNodes.GetN ());
+	for (uint32_t i = 0; i < m_receiverNodes.GetN (); i++)
+	{
+		NetDeviceContainer link = accessLink.Install (m_receiverNodes.Get (i), m_routers.Get (1));
+		Ipv4InterfaceContainer interfaces = address.Assign (link);
+		AddDefaultRoute (m_routing, link.Get (0), interfaces.GetAddress (1));
+		m_receiverAddresses.push_back (interfaces.GetAddress (0));
+		address.NewNetwork ();
+	}
+	PopulateRoutes (m_routing);
+}
+
+inline ApplicationContainer
+DumbbellBuilder::InstallSinks (uint16_t port, Time start, Time stop)
+{
+	m_sinkPort = port;
+	ApplicationContainer sinks;
+	PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+	for (uint32_t i = 0; i < m_receiverNodes.GetN (); i++)
+	{
+		if (IsLocal (m_receiverNodes.Get (i)))
+		{
+			sinks.Add (packetSinkHelper.Install (m_receiverNodes.Get (i)));
+		}
+	}
+	sinks.Start (start);
+	sinks.Stop (stop);
+	return sinks;
+}
+
+inline ApplicationContainer
+DumbbellBuilder::InstallSources (const SourceFactory& factory, Time start, Time stop)
+{
+	ApplicationContainer sources;
+	for (uint32_t flow = 0; flow < GetFlowCount (); flow++)
+	{
+		Ptr<Node> sender = m_senderNodes.Get (flow / m_flowsPerSender);
+		if (!IsLocal (sender))
+		{
+			continue;
+		}
+		Address sink (InetSocketAddress (m_receiverAddresses[flow % m_receiverAddresses.size ()], m_sinkPort));
+		Ptr<Socket> socket = CreateTcpSocket (sender, m_congestionControl[flow % m_congestionControl.size ()]);
+		Ptr<Application> app = factory (socket, sink, flow);
+		sender->AddApplication (app);
+		app->SetStartTime (start);
+		app->SetStopTime (stop);
+		sources.Add (app);
+	}
+	return sources;
+}
+
+inline Ptr<Socket>
+DumbbellBuilder::CreateTcpSocket (Ptr<Node> node, TypeId congestionControl)
+{
+	//the socket type of the node is only read when a socket is created
+	node->GetObject<TcpL4Protocol> ()->SetAttribute ("SocketType", TypeIdValue (congestionControl));
+	return Socket::CreateSocket (node, TcpSocketFactory::GetTypeId ());
+}
+
+inline uint32_t
+DumbbellBuilder::GetFlowCount (void) const
+{
+	return m_senders * m_flowsPerSender;
+}
+
+inline bool
+DumbbellBuilder::IsLocal (Ptr<Node> node) const
+{
+	return node->GetSystemId () == m_rank;
+}
+
+inline const NodeContainer&
+DumbbellBuilder::GetSenders (void) const
+{
+	return m_senderNodes;
+}
+
+inline const NodeContainer&
+DumbbellBuilder::GetReceivers (void) const
+{
+	return m_receiverNodes;
+}
+
+inline Ipv4Address
+DumbbellBuilder::GetReceiverAddress (uint32_t i) const
+{
+	return m_receiverAddresses[i];
+}
+
+inline Ptr<Node>
+DumbbellBuilder::GetLeftRouter (void) const
+{
+	return m_routers.Get (0);
+}
+
+inline Ptr<Node>
+DumbbellBuilder::GetRightRouter (void) const
+{
+	return m_routers.Get (1);
+}
+
+inline Ptr<NetDevice>
+DumbbellBuilder::GetBottleneckDevice (uint32_t i) const
+{
+	return m_bottleneck.Get (i);
+}
+
+} // namespace ns3
+
+#endif /* DUMBBELL_BUILDER_H */
@@ -0,0 +1,228 @@
+#ifndef FAST_WIFI_LINK_H
+#define FAST_WIFI_LINK_H
+
+#include "ns3/core-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace ns3
+{
+
+//airtime and delivery probability of one frame size at one MCS
+struct FastWifiLinkEntry
+{
+	double airtimeUs;            //DIFS, mean backoff, preamble, data symbols, SIFS and ACK of one attempt
+	double deliveryProbability;  //probability that one attempt is received
+	double residualLoss;         //probability that the frame is lost after all retries
+	double expectedAttempts;     //attempts a frame takes on average, each one costing airtimeUs
+};
+
+//Lookup table of an 802.11n (20MHz, one spatial stream, long guard interval, 2.4GHz timing
+//as used by wireless.cc) link. The airtime of a frame is computed from the MCS and the frame size; the delivery
+//probability of an attempt is 1 unless a table file gives it for a (mcs, frame size) pair, in
+//which case the entry with the next larger (or the largest) frame size of that MCS is used.
+class FastWifiLinkTable
+{
+	public:
+		FastWifiLinkTable ();
+
+		//read "mcs,frameBytes,deliveryProbability" lines, lines starting with # are skipped
+		void Load (const std::string& fileName);
+
+		//data bits per OFDM symbol of an MCS (0 to 7)
+		static uint32_t GetDataBitsPerSymbol (uint32_t mcs);
+
+		//phy rate in bit/s of an MCS
+		static double GetPhyRate (uint32_t mcs);
+
+		//airtime of every attempt that does not depend on the frame size in us: contention,
+		//preamble, SIFS and ACK
+		static double GetFixedAirtimeUs (void);
+
+		//airtime of every frame that does not depend on its size: contention, preamble, SIFS and
+		//ACK, plus the 802.11 MAC header bits beyond the Ethernet header a csma device sends
+		static Time GetFrameOverhead (uint32_t mcs);
+
+		//airtime and delivery of an IP packet of frameBytes at mcs
+		FastWifiLinkEntry Lookup (uint32_t mcs, uint32_t frameBytes) const;
+
+		//retransmissions tried by the wifi MAC after the first attempt before a frame is dropped
+		//(the station retry limit, MaxSsrc), and the attempts of a frame in total
+		static const uint32_t RETRY_LIMIT = 7;
+		static const uint32_t MAX_ATTEMPTS = RETRY_LIMIT + 1;
+
+	private:
+		std::map<uint32_t, std::map<uint32_t, double> > m_delivery;
+};
+
+inline
+FastWifiLinkTable::FastWifiLinkTable ()
+{
+}
+
+inline void
+FastWifiLinkTable::Load (const std::string& fileName)
+{
+	std::ifstream file (fileName.c_str ());
+	if (!file)
+	{
+		NS_FATAL_ERROR ("Cannot open fast wifi link table " << fileName);
+	}
+	std::string line;
+	while (std::getline (file, line))
+	{
+		if (line.empty () || line[0] == '#')
+		{
+			continue;
+		}
+		std::replace (line.begin (), line.end (), ',', ' ');
+		std::istringstream fields (line);
+		uint32_t mcs, frameBytes;
+		double probability;
+		if (fields >> mcs >> frameBytes >> probability)
+		{
+			m_delivery[mcs][frameBytes] = probability;
+		}
+	}
+}
+
+inline uint32_t
+FastWifiLinkTable::GetDataBitsPerSymbol (uint32_t mcs)
+{
+	static const uint32_t bits[8] = {26, 52, 78, 104, 156, 208, 234, 260};
+	return bits[mcs < 8 ? mcs : 7];
+}
+
+inline double
+FastWifiLinkTable::GetPhyRate (uint32_t mcs)
+{
+	//one symbol every 4us
+	return GetDataBitsPerSymbol (mcs) / 4e-6;
+}
+
+inline double
+FastWifiLinkTable::GetFixedAirtimeUs (void)
+{
+	//2.4GHz: DIFS 28us, mean backoff of CWmin 15 with 9us slots, HT mixed preamble 36us, SIFS
+	//10us, a legacy 6Mbps ACK of 44us and the 6us signal extension after the data frame and ACK
+	return 28.0 + 7.5 * 9.0 + 36.0 + 6.0 + 10.0 + 44.0 + 6.0;
+}
+
+inline Time
+FastWifiLinkTable::GetFrameOverhead (uint32_t mcs)
+{
+	//service and tail bits and the 20 bytes of 802.11 header, LLC and FCS a csma frame does not
+	//carry are sent at the phy rate
+	double us = GetFixedAirtimeUs ();
+	us += (16 + 6 + 20 * 8) / GetPhyRate (mcs) * 1e6;
+	return NanoSeconds (static_cast<int64_t> (us * 1000));
+}
+
+inline FastWifiLinkEntry
+FastWifiLinkTable::Lookup (uint32_t mcs, uint32_t frameBytes) const
+{
+	FastWifiLinkEntry entry;
+	//data symbols of service, tail and the MPDU (38 bytes of QoS header, LLC/SNAP and FCS)
+	uint32_t bits = 16 + 6 + 8 * (frameBytes + 38);
+	uint32_t symbols = (bits + GetDataBitsPerSymbol (mcs) - 1) / GetDataBitsPerSymbol (mcs);
+	entry.airtimeUs = GetFixedAirtimeUs () + symbols * 4.0;
+
+	entry.deliveryProbability = 1.0;
+	auto sizes = m_delivery.find (mcs);
+	if (sizes != m_delivery.end () && !sizes->second.empty ())
+	{
+		auto it = sizes->second.lower_bound (frameBytes);
+		if (it == sizes->second.end ())
+		{
+			it--;
+		}
+		entry.deliveryProbability = it->second;
+	}
+	entry.residualLoss = std::pow (1.0 - entry.deliveryProbability, MAX_ATTEMPTS);
+	//mean of the attempts, geometric and truncated at the last attempt
+	entry.expectedAttempts = entry.deliveryProbability > 0 ? (1.0 - entry.residualLoss) / entry.deliveryProbability : MAX_ATTEMPTS;
+	return entry;
+}
+
+//Drops the frames received over the abstract link with the residual loss the table gives for
+//their size after the MAC retries.
+class FastWifiErrorModel : public ErrorModel
+{
+	public:
+		static TypeId GetTypeId (void)
+		{
+			static TypeId tid = TypeId ("ns3::FastWifiErrorModel")
+				.SetParent<ErrorModel> ()
+				.AddConstructor<FastWifiErrorModel> ();
+			return tid;
+		}
+
+		FastWifiErrorModel ()
+		: m_mcs (7),
+		m_random (CreateObject<UniformRandomVariable> ())
+		{
+		}
+
+		void SetTable (const FastWifiLinkTable& table, uint32_t mcs)
+		{
+			m_table = table;
+			m_mcs = mcs;
+		}
+
+		int64_t AssignStreams (int64_t stream)
+		{
+			m_random->SetStream (stream);
+			return 1;
+		}
+
+	private:
+		bool DoCorrupt (Ptr<Packet> p) override
+		{
+			double loss = m_table.Lookup (m_mcs, p->GetSize ()).residualLoss;
+			return loss > 0 && m_random->GetValue () < loss;
+		}
+
+		void DoReset (void) override
+		{
+		}
+
+		FastWifiLinkTable m_table;
+		uint32_t m_mcs;
+		Ptr<UniformRandomVariable> m_random;
+};
+
+//Install the abstract link of one BSS on nodes: a shared csma channel whose bit rate is the phy
+//rate of the MCS and whose interframe gap is the per frame overhead of the table, so a frame
+//occupies the medium for its 802.11 airtime and the csma backoff stands in for the contention
+//between stations. Both are scaled by the expected attempts of a frame of frameBytes (the data
+//packets of the flows), so the airtime of the retransmissions is charged as well; frames of
+//other sizes are charged the attempts of frameBytes. Frames are dropped with the residual loss
+//of the table.
+inline NetDeviceContainer
+InstallFastWifiLink (const NodeContainer& nodes, const FastWifiLinkTable& table, uint32_t mcs, uint32_t frameBytes)
+{
+	double attempts = table.Lookup (mcs, frameBytes).expectedAttempts;
+	CsmaHelper csma;
+	csma.SetChannelAttribute ("DataRate", DataRateValue (DataRate (static_cast<uint64_t> (FastWifiLinkTable::GetPhyRate (mcs) / attempts))));
+	csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (0)));
+	csma.SetDeviceAttribute ("InterframeGap", TimeValue (NanoSeconds (static_cast<int64_t> (FastWifiLinkTable::GetFrameOverhead (mcs).GetNanoSeconds () * attempts))));
+	NetDeviceContainer devices = csma.Install (nodes);
+	for (uint32_t i = 0; i < devices.GetN (); i++)
+	{
+		Ptr<FastWifiErrorModel> errorModel = CreateObject<FastWifiErrorModel> ();
+		errorModel->SetTable (table, mcs);
+		devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+	}
+	return devices;
+}
+
+} // namespace ns3
+
+#endif /* FAST_WIFI_LINK_H */
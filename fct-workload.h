@@ -0,0 +1,530 @@
+#ifndef FCT_WORKLOAD_H
+#define FCT_WORKLOAD_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow-accounting.h"
+
+namespace ns3
+{
+
+//Empirical cumulative distribution of flow sizes, sampled by inverse transform with linear
+//interpolation between the points.
+class FlowSizeCdf
+{
+	public:
+		//the web search distribution of the DCTCP paper (sizes in 1460 byte packets)
+		FlowSizeCdf ();
+
+		//read "sizeBytes cumulativeProbability" lines (space or comma separated, # comments),
+		//the probabilities must not decrease and the last one must be 1
+		void Load (const std::string& fileName);
+
+		uint64_t Sample (double uniform) const;
+		double GetMean (void) const;
+
+	private:
+		std::vector<std::pair<double, double> > m_points;  //(size, cumulative probability)
+};
+
+inline
+FlowSizeCdf::FlowSizeCdf ()
+{
+	const double packets[][2] = {{1, 0}, {6, 0.15}, {13, 0.2}, {19, 0.3}, {33, 0.4}, {53, 0.53}, {133, 0.6},
+	                             {667, 0.7}, {1333, 0.8}, {3333, 0.9}, {6667, 0.97}, {20000, 1.0}};
+	for (const auto& point : packets)
+	{
+		m_points.push_back (std::make_pair (point[0] * 1460, point[1]));
+	}
+}
+
+inline void
+FlowSizeCdf::Load (const std::string& fileName)
+{
+	std::ifstream file (fileName.c_str ());
+	if (!file)
+	{
+		NS_FATAL_ERROR ("Cannot open flow size cdf " << fileName);
+	}
+	m_points.clear ();
+	std::string line;
+	while (std::getline (file, line))
+	{
+		if (line.empty () || line[0] == '#')
+		{
+			continue;
+		}
+		std::replace (line.begin (), line.end (), ',', ' ');
+		std::istringstream fields (line);
+		double size, probability;
+		if (fields >> size >> probability)
+		{
+			if (!m_points.empty () && probability < m_points.back ().second)
+			{
+				NS_FATAL_ERROR ("Flow size cdf " << fileName << " decreases at size " << size);
+			}
+			m_points.push_back (std::make_pair (size, probability));
+		}
+	}
+	if (m_points.empty () || m_points.back ().second < 1.0)
+	{
+		NS_FATAL_ERROR ("Flow size cdf " << fileName << " does not reach 1");
+	}
+}
+
+inline uint64_t
+FlowSizeCdf::Sample (double uniform) const
+{
+	for (size_t i = 0; i < m_points.size (); i++)
+	{
+		if (uniform <= m_points[i].second)
+		{
+			if (i == 0 || m_points[i].second == m_points[i - 1].second)
+			{
+				return std::max<uint64_t> (1, m_points[i].first);
+			}
+			double fraction = (uniform - m_points[i - 1].second) / (m_points[i].second - m_points[i - 1].second);
+			double size = m_points[i - 1].first + fraction * (m_points[i].first - m_points[i - 1].first);
+			return std::max<uint64_t> (1, std::llround (size));
+		}
+	}
+	return std::max<uint64_t> (1, m_points.back ().first);
+}
+
+inline double
+FlowSizeCdf::GetMean (void) const
+{
+	//mean of the piecewise linear distribution: the midpoint of every segment times its probability
+	double mean = m_points.empty () ? 0 : m_points[0].first * m_points[0].second;
+	for (size_t i = 1; i < m_points.size (); i++)
+	{
+		mean += (m_points[i].second - m_points[i - 1].second) * (m_points[i].first + m_points[i - 1].first) / 2;
+	}
+	return mean;
+}
+
+//Open loop flow completion time workload: flows arrive as a Poisson process, each one between a
+//random sender and a random receiver with a size drawn from a FlowSizeCdf. A flow opens a tcp
+//connection, writes its bytes, closes, and completes when the receiver has read all of them.
+//The completion times go into log binned histograms per size bucket, so the memory of the
+//statistics is fixed. The state of the active flows lives in a pool of slots that are reused
+//once a flow completes, with no application object per flow. ns-3 tcp sockets cannot be
+//connected again after a close, so every flow opens a new socket; its TIME_WAIT is shortened
+//so that the closed sockets are released soon after their flow.
+class FctWorkload
+{
+	public:
+		FctWorkload ();
+
+		void SetCdf (const FlowSizeCdf& cdf);
+		void SetArrivalRate (double flowsPerSecond);
+		void SetSegmentSize (uint32_t bytes);
+		void SetTimeWait (Time timeWait);
+
+		void AddSender (Ptr<Node> node);
+		void AddReceiver (Ptr<Node> node, Ipv4Address address);
+
+		//listen on port on every receiver and start arrivals from start until stop
+		void Install (uint16_t port, Time start, Time stop);
+
+		int64_t AssignStreams (int64_t stream);
+
+		uint64_t GetCompletedBytes (void) const;
+
+		//started, completed and unfinished flows and the 50th, 95th and 99th percentile of the
+		//completion time in ms per size bucket, with the relative error of the percentiles
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+		//upper limits of the size buckets in bytes, the last bucket is unbounded
+		static const uint32_t SIZE_BUCKETS = 5;
+		static constexpr uint64_t SIZE_LIMITS[SIZE_BUCKETS] = {10000, 100000, 1000000, 10000000, UINT64_MAX};
+		static std::string GetSizeBucketName (uint32_t bucket);
+
+	private:
+		//completion times in 20 log bins per decade from 10us to 1000s
+		struct Histogram
+		{
+			std::vector<uint64_t> bins;
+			uint64_t count;
+			double sum;
+		};
+
+		struct Flow
+		{
+			uint64_t size;
+			uint64_t sent;
+			uint64_t received;
+			Time start;
+			uint64_t endpoint;   //sender address and port, key of m_endpoints
+			Ptr<Socket> socket;
+		};
+
+		static const uint32_t BINS_PER_DECADE = 20;
+		static const int32_t FIRST_DECADE = -5;
+		static const uint32_t DECADES = 8;
+
+		void Arrival (void);
+		uint32_t AllocateFlow (void);
+		void ReleaseFlow (uint32_t index);
+		void Record (const Flow& flow);
+
+		void Accept (Ptr<Socket> socket, const Address& from);
+		static void Connected (FctWorkload* workload, uint32_t index, Ptr<Socket> socket);
+		static void ConnectFailed (FctWorkload* workload, uint32_t index, Ptr<Socket> socket);
+		static void SendMore (FctWorkload* workload, uint32_t index, Ptr<Socket> socket, uint32_t available);
+		static void Receive (FctWorkload* workload, uint32_t index, Ptr<Socket> socket);
+
+		//geometric midpoint of the bin holding the percentile, 0 if the histogram is empty
+		static double GetPercentile (const Histogram& histogram, double fraction);
+
+		//largest relative error of a percentile between 10us and 1000s taken from a bin midpoint:
+		//half a bin, 10^(1/40) - 1 = 5.9%
+		static double GetRelativeError (void);
+
+		FlowSizeCdf m_cdf;
+		double m_rate;
+		uint32_t m_segmentSize;
+		Time m_timeWait;
+		uint16_t m_port;
+		Time m_stop;
+		std::vector<Ptr<Node> > m_senders;
+		std::vector<Ptr<Node> > m_receivers;
+		std::vector<Ipv4Address> m_receiverAddresses;
+		std::vector<Ptr<Socket> > m_listeners;
+		Ptr<ExponentialRandomVariable> m_interArrival;
+		Ptr<UniformRandomVariable> m_uniform;
+
+		std::vector<Flow> m_flows;
+		std::vector<uint32_t> m_free;
+		std::unordered_map<uint64_t, uint32_t> m_endpoints;
+
+		std::vector<Histogram> m_histograms;
+		uint64_t m_started;
+		uint64_t m_failed;
+		uint64_t m_completedBytes;
+};
+
+inline
+FctWorkload::FctWorkload ()
+: m_rate (100),
+m_segmentSize (1448),
+m_timeWait (Seconds (1)),
+m_port (0),
+m_interArrival (CreateObject<ExponentialRandomVariable> ()),
+m_uniform (CreateObject<UniformRandomVariable> ()),
+m_started (0),
+m_failed (0),
+m_completedBytes (0)
+{
+	Histogram empty;
+	empty.bins.assign (BINS_PER_DECADE * DECADES, 0);
+	empty.count = 0;
+	empty.sum = 0;
+	m_histograms.assign (SIZE_BUCKETS, empty);
+}
+
+inline void
+FctWorkload::SetCdf (const FlowSizeCdf& cdf)
+{
+	m_cdf = cdf;
+}
+
+inline void
+FctWorkload::SetArrivalRate (double flowsPerSecond)
+{
+	m_rate = flowsPerSecond;
+}
+
+inline void
+FctWorkload::SetSegmentSize (uint32_t bytes)
+{
+	m_segmentSize = bytes;
+}
+
+inline void
+FctWorkload::SetTimeWait (Time timeWait)
+{
+	m_timeWait = timeWait;
+}
+
+inline void
+FctWorkload::AddSender (Ptr<Node> node)
+{
+	m_senders.push_back (node);
+}
+
+inline void
+FctWorkload::AddReceiver (Ptr<Node> node, Ipv4Address address)
+{
+	m_receivers.push_back (node);
+	m_receiverAddresses.push_back (address);
+}
+
+inline std::string
+FctWorkload::GetSizeBucketName (uint32_t bucket)
+{
+	const char* names[] = {"0-10KB", "10KB-100KB", "100KB-1MB", "1MB-10MB", "10MB+"};
+	return names[bucket];
+}
+
+inline int64_t
+FctWorkload::AssignStreams (int64_t stream)
+{
+	m_interArrival->SetStream (stream);
+	m_uniform->SetStream (stream + 1);
+	return 2;
+}
+
+inline void
+FctWorkload::Install (uint16_t port, Time start, Time stop)
+{
+	NS_ABORT_MSG_IF (m_senders.empty () || m_receivers.empty (), "The fct workload needs senders and receivers");
+	m_port = port;
+	m_stop = stop;
+	for (uint32_t i = 0; i < m_receivers.size (); i++)
+	{
+		Ptr<Socket> listener = Socket::CreateSocket (m_receivers[i], TcpSocketFactory::GetTypeId ());
+		listener->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+		listener->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+		listener->Listen ();
+		listener->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address&> (),
+		                             MakeCallback (&FctWorkload::Accept, this));
+		m_listeners.push_back (listener);
+	}
+	m_interArrival->SetAttribute ("Mean", DoubleValue (1.0 / m_rate));
+	Simulator::Schedule (start, &FctWorkload::Arrival, this);
+}
+
+inline uint32_t
+FctWorkload::AllocateFlow (void)
+{
+	if (!m_free.empty ())
+	{
+		uint32_t index = m_free.back ();
+		m_free.pop_back ();
+		return index;
+	}
+	m_flows.emplace_back ();
+	return m_flows.size () - 1;
+}
+
+inline void
+FctWorkload::ReleaseFlow (uint32_t index)
+{
+	Flow& flow = m_flows[index];
+	m_endpoints.erase (flow.endpoint);
+	flow.socket = nullptr;
+	m_free.push_back (index);
+}
+
+inline void
+FctWorkload::Arrival (void)
+{
+	if (Simulator::Now () >= m_stop)
+	{
+		return;
+	}
+	Simulator::Schedule (Seconds (m_interArrival->GetValue ()), &FctWorkload::Arrival, this);
+
+	Ptr<Node> sender = m_senders[m_uniform->GetInteger (0, m_senders.size () - 1)];
+	uint32_t receiver = m_uniform->GetInteger (0, m_receivers.size () - 1);
+	uint32_t index = AllocateFlow ();
+	Flow& flow = m_flows[index];
+	flow.size = m_cdf.Sample (m_uniform->GetValue ());
+	flow.sent = 0;
+	flow.received = 0;
+	flow.start = Simulator::Now ();
+	m_started++;
+
+	Ptr<Socket> socket = Socket::CreateSocket (sender, TcpSocketFactory::GetTypeId ());
+	socket->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+	socket->SetAttribute ("MaxSegLifetime", DoubleValue (m_timeWait.GetSeconds () / 2));
+	socket->Bind ();
+	Address local;
+	socket->GetSockName (local);
+	//the receiver finds the flow by the address and port of the sender
+	Ipv4Address senderAddress = sender->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+	flow.endpoint = GetEndpointKey (senderAddress, InetSocketAddress::ConvertFrom (local).GetPort ());
+	m_endpoints[flow.endpoint] = index;
+	flow.socket = socket;
+	socket->SetConnectCallback (MakeBoundCallback (&FctWorkload::Connected, this, index),
+	                            MakeBoundCallback (&FctWorkload::ConnectFailed, this, index));
+	socket->SetSendCallback (MakeBoundCallback (&FctWorkload::SendMore, this, index));
+	socket->Connect (InetSocketAddress (m_receiverAddresses[receiver], m_port));
+}
+
+inline void
+FctWorkload::Connected (FctWorkload* workload, uint32_t index, Ptr<Socket> socket)
+{
+	SendMore (workload, index, socket, socket->GetTxAvailable ());
+}
+
+inline void
+FctWorkload::ConnectFailed (FctWorkload* workload, uint32_t index, Ptr<Socket> socket)
+{
+	workload->m_failed++;
+	workload->ReleaseFlow (index);
+}
+
+inline void
+FctWorkload::SendMore (FctWorkload* workload, uint32_t index, Ptr<Socket> socket, uint32_t available)
+{
+	Flow& flow = workload->m_flows[index];
+	if (flow.socket != socket)
+	{
+		return;
+	}
+	while (flow.sent < flow.size)
+	{
+		uint32_t chunk = std::min<uint64_t> (flow.size - flow.sent, socket->GetTxAvailable ());
+		if (chunk == 0)
+		{
+			return;
+		}
+		int sent = socket->Send (Create<Packet> (chunk));
+		if (sent <= 0)
+		{
+			return;
+		}
+		flow.sent += sent;
+	}
+	//all bytes are queued, the fin follows them
+	socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+	socket->Close ();
+}
+
+inline void
+FctWorkload::Accept (Ptr<Socket> socket, const Address& from)
+{
+	InetSocketAddress address = InetSocketAddress::ConvertFrom (from);
+	auto it = m_endpoints.find (GetEndpointKey (address.GetIpv4 (), address.GetPort ()));
+	if (it == m_endpoints.end ())
+	{
+		socket->Close ();
+		return;
+	}
+	socket->SetRecvCallback (MakeBoundCallback (&FctWorkload::Receive, this, it->second));
+}
+
+inline void
+FctWorkload::Receive (FctWorkload* workload, uint32_t index, Ptr<Socket> socket)
+{
+	Flow& flow = workload->m_flows[index];
+	Ptr<Packet> packet;
+	while ((packet = socket->Recv ()))
+	{
+		flow.received += packet->GetSize ();
+	}
+	if (flow.socket != nullptr && flow.received >= flow.size)
+	{
+		workload->Record (flow);
+		socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+		socket->Close ();
+		workload->ReleaseFlow (index);
+	}
+}
+
+inline void
+FctWorkload::Record (const Flow& flow)
+{
+	uint32_t bucket = 0;
+	while (flow.size > SIZE_LIMITS[bucket])
+	{
+		bucket++;
+	}
+	Histogram& histogram = m_histograms[bucket];
+	double seconds = (Simulator::Now () - flow.start).GetSeconds ();
+	double position = (std::log10 (std::max (seconds, 1e-12)) - FIRST_DECADE) * BINS_PER_DECADE;
+	uint32_t bin = position < 0 ? 0 : std::min<uint32_t> (position, histogram.bins.size () - 1);
+	histogram.bins[bin]++;
+	histogram.count++;
+	histogram.sum += seconds;
+	m_completedBytes += flow.size;
+}
+
+inline double
+FctWorkload::GetPercentile (const Histogram& histogram, double fraction)
+{
+	uint64_t seen = 0;
+	for (uint32_t bin = 0; bin < histogram.bins.size (); bin++)
+	{
+		seen += histogram.bins[bin];
+		if (seen > 0 && seen >= fraction * histogram.count)
+		{
+			return std::pow (10.0, FIRST_DECADE + (bin + 0.5) / BINS_PER_DECADE);
+		}
+	}
+	return 0;
+}
+
+inline double
+FctWorkload::GetRelativeError (void)
+{
+	return std::pow (10.0, 0.5 / BINS_PER_DECADE) - 1;
+}
+
+inline uint64_t
+FctWorkload::GetCompletedBytes (void) const
+{
+	return m_completedBytes;
+}
+
+inline void
+FctWorkload::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	uint64_t completed = 0;
+	for (uint32_t bucket = 0; bucket < m_histograms.size (); bucket++)
+	{
+		const Histogram& histogram = m_histograms[bucket];
+		std::string prefix = "fct." + GetSizeBucketName (bucket) + ".";
+		metrics[prefix + "flows"] = histogram.count;
+		metrics[prefix + "meanMs"] = histogram.count > 0 ? 1000 * histogram.sum / histogram.count : 0.0;
+		metrics[prefix + "p50Ms"] = 1000 * GetPercentile (histogram, 0.5);
+		metrics[prefix + "p95Ms"] = 1000 * GetPercentile (histogram, 0.95);
+		metrics[prefix + "p99Ms"] = 1000 * GetPercentile (histogram, 0.99);
+		completed += histogram.count;
+	}
+	metrics["fctStarted"] = m_started;
+	metrics["fctCompleted"] = completed;
+	metrics["fctFailed"] = m_failed;
+	metrics["fctUnfinished"] = m_started - completed - m_failed;
+	metrics["fctFlowSlots"] = m_flows.size ();
+	metrics["fctRelativeError"] = GetRelativeError ();
+}
+
+//print the completion time percentiles of a sweep point recorded by FctWorkload::AddMetrics
+inline void
+PrintFctMetrics (std::ostream& os, const std::map<std::string, double>& metrics)
+{
+	auto started = metrics.find ("fctStarted");
+	if (started == metrics.end ())
+	{
+		return;
+	}
+	os << "Flows : " << started->second << " started, " << metrics.at ("fctCompleted") << " completed, "
+	   << metrics.at ("fctUnfinished") << " unfinished, " << metrics.at ("fctFlowSlots") << " flow slots\n";
+	os << "Size\t\tFlows\tMean(ms)\tp50(ms)\tp95(ms)\tp99(ms) (percentiles +-" << 100 * metrics.at ("fctRelativeError") << "%)\n";
+	for (uint32_t bucket = 0; bucket < FctWorkload::SIZE_BUCKETS; bucket++)
+	{
+		std::string prefix = "fct." + FctWorkload::GetSizeBucketName (bucket) + ".";
+		os << FctWorkload::GetSizeBucketName (bucket) << "\t" << (bucket == 1 ? "" : "\t") << metrics.at (prefix + "flows") << "\t"
+		   << metrics.at (prefix + "meanMs") << "\t\t" << metrics.at (prefix + "p50Ms") << "\t"
+		   << metrics.at (prefix + "p95Ms") << "\t" << metrics.at (prefix + "p99Ms") << "\n";
+	}
+}
+
+} // namespace ns3
+
+#endif /* FCT_WORKLOAD_H */
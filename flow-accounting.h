@@ -0,0 +1,212 @@
+#ifndef FLOW_ACCOUNTING_H
+#define FLOW_ACCOUNTING_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//key of the ipv4 address and port a flow is sent from, used to find the flow of a received packet
+inline uint64_t
+GetEndpointKey (Ipv4Address address, uint16_t port)
+{
+	return (static_cast<uint64_t> (address.Get ()) << 16) | port;
+}
+
+//key of an InetSocketAddress, 0 for other addresses
+inline uint64_t
+GetEndpointKey (const Address& address)
+{
+	if (!InetSocketAddress::IsMatchingType (address))
+	{
+		return 0;
+	}
+	InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+	return GetEndpointKey (inet.GetIpv4 (), inet.GetPort ());
+}
+
+//Low overhead alternative to FlowMonitorHelper::InstallAll. Instead of classifying every
+//packet at every hop it only hooks the "TxWithAddresses" trace of the source applications
+//and the "RxWithAddresses" trace of the packet sinks and keeps a few counters per flow in a
+//flat vector indexed by flow. Only application payload of the data direction is counted.
+class FlowAccounting
+{
+	public:
+		//counters kept for every flow
+		struct FlowCounters
+		{
+			uint64_t txBytes;
+			uint64_t rxBytes;
+			Time firstTx;
+			Time lastRx;
+			bool started;
+			std::string type;     //congestion control of the source, empty for flows learned from the sink
+		};
+
+		FlowAccounting ();
+
+		//account the packets sent by a source application (MyApp or OnOffApplication) as one flow
+		//using the congestion control type, returns the index of the flow
+		uint32_t AddSource (Ptr<Application> app, const std::string& type = "");
+
+		//account the packets received by a packet sink, the sending flow is found by its address
+		void AddSink (Ptr<Application> sink);
+
+		//create a flow for every unknown sender seen by the sinks, used when the sources run in
+		//another process (distributed simulation). The first tx time is then the first rx time.
+		void SetLearnFlowsFromSink (bool learn);
+
+		//return the counters of all flows
+		const std::vector<FlowCounters>& GetFlows (void) const;
+
+		//congestion control type of the flow sent from address and port, empty if no source sent from it
+		std::string GetFlowType (Ipv4Address address, uint16_t port) const;
+
+		//fill the per-flow throughput, average throughput and fairness of a sweep point,
+		//flows get the ids 1, 2, 3, ... in the order they were added like the data flows of FlowMonitor
+		void FillResult (SweepPointResult& result) const;
+
+	private:
+		//trace sinks, the flow index is bound when connecting so no lookup is needed on tx
+		static void NotifyTx (FlowAccounting* accounting, uint32_t flow, Ptr<const Packet> packet,
+		                      const Address& from, const Address& to);
+		static void NotifyRx (FlowAccounting* accounting, Ptr<const Packet> packet,
+		                      const Address& from, const Address& to);
+
+		std::vector<FlowCounters> m_flows;
+		std::unordered_map<uint64_t, uint32_t> m_flowByEndpoint;
+		uint64_t m_lastKey;   //last looked up endpoint, packets of one flow come in bursts
+		uint32_t m_lastFlow;
+		bool m_learnFlows;
+};
+
+inline
+FlowAccounting::FlowAccounting ()
+: m_lastKey (std::numeric_limits<uint64_t>::max ()),
+m_lastFlow (0),
+m_learnFlows (false)
+{
+}
+
+inline uint32_t
+FlowAccounting::AddSource (Ptr<Application> app, const std::string& type)
+{
+	uint32_t flow = m_flows.size ();
+	m_flows.push_back ({0, 0, Seconds (0), Seconds (0), false, type});
+	app->TraceConnectWithoutContext ("TxWithAddresses", MakeBoundCallback (&FlowAccounting::NotifyTx, this, flow));
+	return flow;
+}
+
+inline void
+FlowAccounting::AddSink (Ptr<Application> sink)
+{
+	sink->TraceConnectWithoutContext ("RxWithAddresses", MakeBoundCallback (&FlowAccounting::NotifyRx, this));
+}
+
+inline void
+FlowAccounting::SetLearnFlowsFromSink (bool learn)
+{
+	m_learnFlows = learn;
+}
+
+inline const std::vector<FlowAccounting::FlowCounters>&
+FlowAccounting::GetFlows (void) const
+{
+	return m_flows;
+}
+
+inline std::string
+FlowAccounting::GetFlowType (Ipv4Address address, uint16_t port) const
+{
+	auto it = m_flowByEndpoint.find (GetEndpointKey (address, port));
+	return it != m_flowByEndpoint.end () ? m_flows[it->second].type : std::string ();
+}
+
+inline void
+FlowAccounting::NotifyTx (FlowAccounting* accounting, uint32_t flow, Ptr<const Packet> packet,
+                          const Address& from, const Address& to)
+{
+	FlowCounters& counters = accounting->m_flows[flow];
+	if (!counters.started)
+	{
+		//the local port is known once the first packet is sent, remember it for the sink side
+		counters.started = true;
+		counters.firstTx = Simulator::Now ();
+		accounting->m_flowByEndpoint[GetEndpointKey (from)] = flow;
+	}
+	counters.txBytes += packet->GetSize ();
+}
+
+inline void
+FlowAccounting::NotifyRx (FlowAccounting* accounting, Ptr<const Packet> packet,
+                          const Address& from, const Address& to)
+{
+	uint64_t key = GetEndpointKey (from);
+	if (key == 0)
+	{
+		return;
+	}
+	if (key != accounting->m_lastKey)
+	{
+		auto it = accounting->m_flowByEndpoint.find (key);
+		if (it == accounting->m_flowByEndpoint.end ())
+		{
+			if (!accounting->m_learnFlows)
+			{
+				return;
+			}
+			uint32_t flow = accounting->m_flows.size ();
+			accounting->m_flows.push_back ({0, 0, Simulator::Now (), Simulator::Now (), true, ""});
+			it = accounting->m_flowByEndpoint.insert (std::make_pair (key, flow)).first;
+		}
+		accounting->m_lastKey = key;
+		accounting->m_lastFlow = it->second;
+	}
+	FlowCounters& counters = accounting->m_flows[accounting->m_lastFlow];
+	counters.rxBytes += packet->GetSize ();
+	counters.lastRx = Simulator::Now ();
+}
+
+inline void
+FlowAccounting::FillResult (SweepPointResult& result) const
+{
+	//throughput is calculated as (number of bits received by sink) / (time when last packet was received - time when first packet was transmitted)
+	//jain's fairness index = (sum of throughputs)^2 / (number of flows * sum of squares of throughputs)
+	double throughputSum = 0.0, throughputSquareSum = 0.0;
+	for (uint32_t i = 0; i < m_flows.size (); i++)
+	{
+		const FlowCounters& counters = m_flows[i];
+		FlowResult flow;
+		flow.flowId = i + 1;
+		flow.rxBytes = counters.rxBytes;
+		flow.firstTx = counters.firstTx.GetSeconds ();
+		flow.lastRx = counters.lastRx.GetSeconds ();
+		flow.type = counters.type;
+		flow.throughput = 0.0;
+		if (flow.lastRx > flow.firstTx)
+		{
+			flow.throughput = (flow.rxBytes * 8.0) / (flow.lastRx - flow.firstTx) / 1024;
+		}
+		throughputSum += flow.throughput;
+		throughputSquareSum += flow.throughput * flow.throughput;
+		result.flows.push_back (flow);
+	}
+	if (!m_flows.empty () && throughputSquareSum > 0)
+	{
+		result.avgThroughput = throughputSum / m_flows.size ();
+		result.fairness = (throughputSum * throughputSum) / (m_flows.size () * throughputSquareSum);
+	}
+}
+
+} // namespace ns3
+
+#endif /* FLOW_ACCOUNTING_H */
@@ -0,0 +1,483 @@
+#ifndef FLOW_SKETCH_H
+#define FLOW_SKETCH_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow-accounting.h"
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//DDSketch: quantiles of positive values with a relative error of at most relativeAccuracy, in
+//at most maxBuckets log spaced buckets. Bucket i holds the values in (gamma^(i-1), gamma^i] with
+//gamma = (1 + a) / (1 - a). Once the range needs more buckets the lowest ones are merged, so only
+//the quantiles falling into the merged bucket lose the guarantee (IsCollapsed tells).
+class DdSketch
+{
+	public:
+		DdSketch (double relativeAccuracy, uint32_t maxBuckets);
+
+		void Add (double value);
+
+		//value at quantile q in [0, 1], 0 if the sketch is empty
+		double GetQuantile (double q) const;
+
+		uint64_t GetCount (void) const;
+		double GetRelativeAccuracy (void) const;
+		bool IsCollapsed (void) const;
+
+	private:
+		double m_accuracy;
+		double m_gamma;
+		double m_logGamma;
+		uint32_t m_maxBuckets;
+		std::vector<uint64_t> m_buckets;
+		int32_t m_offset;     //index of m_buckets[0]
+		uint64_t m_zeros;     //values <= 0
+		uint64_t m_count;
+		bool m_collapsed;
+};
+
+inline
+DdSketch::DdSketch (double relativeAccuracy, uint32_t maxBuckets)
+: m_accuracy (std::min (std::max (relativeAccuracy, 1e-6), 0.5)),
+m_gamma ((1 + m_accuracy) / (1 - m_accuracy)),
+m_logGamma (std::log (m_gamma)),
+m_maxBuckets (std::max<uint32_t> (maxBuckets, 1)),
+m_offset (0),
+m_zeros (0),
+m_count (0),
+m_collapsed (false)
+{
+}
+
+inline void
+DdSketch::Add (double value)
+{
+	m_count++;
+	if (value <= 0)
+	{
+		m_zeros++;
+		return;
+	}
+	int32_t index = static_cast<int32_t> (std::ceil (std::log (value) / m_logGamma));
+	if (m_buckets.empty ())
+	{
+		m_offset = index;
+		m_buckets.push_back (0);
+	}
+	if (index < m_offset)
+	{
+		uint32_t grow = m_offset - index;
+		if (m_buckets.size () + grow > m_maxBuckets)
+		{
+			//below the kept range, count it in the lowest bucket
+			m_collapsed = true;
+			index = m_offset;
+		}
+		else
+		{
+			m_buckets.insert (m_buckets.begin (), grow, 0);
+			m_offset = index;
+		}
+	}
+	else if (index >= m_offset + static_cast<int32_t> (m_buckets.size ()))
+	{
+		m_buckets.resize (index - m_offset + 1, 0);
+		if (m_buckets.size () > m_maxBuckets)
+		{
+			//merge the lowest buckets into the lowest one kept
+			uint32_t excess = m_buckets.size () - m_maxBuckets;
+			for (uint32_t i = 0; i < excess; i++)
+			{
+				m_buckets[excess] += m_buckets[i];
+			}
+			m_buckets.erase (m_buckets.begin (), m_buckets.begin () + excess);
+			m_offset += excess;
+			m_collapsed = true;
+		}
+	}
+	m_buckets[index - m_offset]++;
+}
+
+inline double
+DdSketch::GetQuantile (double q) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+	uint64_t rank = static_cast<uint64_t> (std::max (0.0, std::min (q, 1.0)) * (m_count - 1));
+	if (rank < m_zeros)
+	{
+		return 0;
+	}
+	uint64_t seen = m_zeros;
+	for (uint32_t i = 0; i < m_buckets.size (); i++)
+	{
+		seen += m_buckets[i];
+		if (seen > rank)
+		{
+			//the value in the bucket with the smallest relative error to both of its ends
+			return 2 * std::pow (m_gamma, m_offset + static_cast<int32_t> (i)) / (m_gamma + 1);
+		}
+	}
+	return 2 * std::pow (m_gamma, m_offset + static_cast<int32_t> (m_buckets.size ()) - 1) / (m_gamma + 1);
+}
+
+inline uint64_t
+DdSketch::GetCount (void) const
+{
+	return m_count;
+}
+
+inline double
+DdSketch::GetRelativeAccuracy (void) const
+{
+	return m_accuracy;
+}
+
+inline bool
+DdSketch::IsCollapsed (void) const
+{
+	return m_collapsed;
+}
+
+//Flow statistics in memory bounded by the number of flows active at the same time instead of
+//the number of flows of the run. Like FlowAccounting it hooks the "TxWithAddresses" trace of the
+//source applications and the "RxWithAddresses" trace of the packet sinks, with the flow found
+//by the address and port of the source. A flow idle for longer than the idle timeout (or the
+//least recently active one once maxActiveFlows are tracked) is folded into:
+//- the exact sums giving the average throughput and Jain's fairness index of FlowAccounting
+//- the exact counters of the topFlows flows with the most received bytes
+//One-way delay and jitter (the change of the delay between consecutive packets of a flow) of
+//every received packet go into DDSketches, measured like LatencyTracker does. A flow folded
+//while it still sends (an idle timeout shorter than a tcp stall, or an eviction) is counted
+//twice when seen again. Without an idle timeout flows are only folded when evicted and at the end.
+class SketchAccounting
+{
+	public:
+		SketchAccounting (uint32_t topFlows, uint32_t maxActiveFlows, Time idleTimeout, double relativeAccuracy);
+
+		//the flows sent by app are reported with the congestion control type
+		void AddSource (Ptr<Application> app, const std::string& type = "");
+		void AddSink (Ptr<Application> sink);
+
+		//start folding idle flows, call before the simulation starts
+		void Start (void);
+
+		//fold the remaining flows and fill the top flows, average throughput, fairness, delay and
+		//jitter percentiles and the error bounds of a sweep point
+		void FillResult (SweepPointResult& result);
+
+	private:
+		struct ActiveFlow
+		{
+			uint32_t flowId;
+			uint32_t source;    //index of the type of the source, m_types.size () if not known
+			uint64_t rxBytes;
+			Time firstTx;
+			Time lastRx;
+			Time lastActivity;
+			std::list<uint64_t>::iterator recent;   //position in m_recent
+			Time lastDelay;
+			bool hasDelay;
+			DelayJitterEstimation delay;
+		};
+
+		static void NotifyTx (SketchAccounting* accounting, uint32_t source, Ptr<const Packet> packet, const Address& from, const Address& to);
+		static void NotifyRx (SketchAccounting* accounting, Ptr<const Packet> packet, const Address& from, const Address& to);
+
+		ActiveFlow& GetFlow (uint64_t key, bool fromSink);
+		void Touch (ActiveFlow& flow);
+		void Fold (const ActiveFlow& flow);
+		void FoldIdle (void);
+		void EvictOldest (void);
+
+		uint32_t m_topFlows;
+		uint32_t m_maxActiveFlows;
+		Time m_idleTimeout;
+		std::unordered_map<uint64_t, ActiveFlow> m_active;
+		std::list<uint64_t> m_recent;   //keys of the active flows, least recently active first
+		uint32_t m_peakActive;
+		uint32_t m_nextFlowId;  //ids 1, 2, 3, ... in the order flows are seen like the data flows of FlowMonitor
+		std::vector<std::string> m_types;   //congestion control type of every source added
+
+		//exact aggregates of the folded flows
+		uint32_t m_flows;
+		double m_throughputSum;
+		double m_throughputSquareSum;
+		uint64_t m_rxBytes;
+		uint32_t m_evictions;
+		uint32_t m_sinkOnlyFlows;
+
+		//min-heap on the received bytes of the top flows
+		std::vector<FlowResult> m_top;
+
+		DdSketch m_delay;
+		DdSketch m_jitter;
+};
+
+inline
+SketchAccounting::SketchAccounting (uint32_t topFlows, uint32_t maxActiveFlows, Time idleTimeout, double relativeAccuracy)
+: m_topFlows (topFlows),
+m_maxActiveFlows (std::max<uint32_t> (maxActiveFlows, 1)),
+m_idleTimeout (idleTimeout),
+m_peakActive (0),
+m_nextFlowId (1),
+m_flows (0),
+m_throughputSum (0),
+m_throughputSquareSum (0),
+m_rxBytes (0),
+m_evictions (0),
+m_sinkOnlyFlows (0),
+m_delay (relativeAccuracy, 2048),
+m_jitter (relativeAccuracy, 2048)
+{
+}
+
+inline void
+SketchAccounting::AddSource (Ptr<Application> app, const std::string& type)
+{
+	uint32_t source = m_types.size ();
+	m_types.push_back (type);
+	app->TraceConnectWithoutContext ("TxWithAddresses", MakeBoundCallback (&SketchAccounting::NotifyTx, this, source));
+}
+
+inline void
+SketchAccounting::AddSink (Ptr<Application> sink)
+{
+	sink->TraceConnectWithoutContext ("RxWithAddresses", MakeBoundCallback (&SketchAccounting::NotifyRx, this));
+}
+
+inline void
+SketchAccounting::Start (void)
+{
+	if (m_idleTimeout.IsStrictlyPositive ())
+	{
+		Simulator::Schedule (m_idleTimeout, &SketchAccounting::FoldIdle, this);
+	}
+}
+
+inline SketchAccounting::ActiveFlow&
+SketchAccounting::GetFlow (uint64_t key, bool fromSink)
+{
+	auto it = m_active.find (key);
+	if (it != m_active.end ())
+	{
+		return it->second;
+	}
+	if (m_active.size () >= m_maxActiveFlows)
+	{
+		EvictOldest ();
+	}
+	//flows seen first at the sink (sources in another process, or folded too early) start there
+	if (fromSink)
+	{
+		m_sinkOnlyFlows++;
+	}
+	ActiveFlow& flow = m_active[key];
+	flow.flowId = m_nextFlowId++;
+	flow.source = m_types.size ();
+	flow.rxBytes = 0;
+	flow.firstTx = Simulator::Now ();
+	flow.lastRx = Simulator::Now ();
+	flow.lastActivity = Simulator::Now ();
+	flow.recent = m_recent.insert (m_recent.end (), key);
+	flow.hasDelay = false;
+	m_peakActive = std::max<uint32_t> (m_peakActive, m_active.size ());
+	return flow;
+}
+
+inline void
+SketchAccounting::NotifyTx (SketchAccounting* accounting, uint32_t source, Ptr<const Packet> packet, const Address& from, const Address& to)
+{
+	uint64_t key = GetEndpointKey (from);
+	if (key == 0)
+	{
+		return;
+	}
+	ActiveFlow& flow = accounting->GetFlow (key, false);
+	flow.source = source;
+	accounting->Touch (flow);
+	DelayJitterEstimation::PrepareTx (packet);
+}
+
+inline void
+SketchAccounting::NotifyRx (SketchAccounting* accounting, Ptr<const Packet> packet, const Address& from, const Address& to)
+{
+	uint64_t key = GetEndpointKey (from);
+	if (key == 0)
+	{
+		return;
+	}
+	ActiveFlow& flow = accounting->GetFlow (key, true);
+	flow.rxBytes += packet->GetSize ();
+	flow.lastRx = Simulator::Now ();
+	accounting->Touch (flow);
+
+	//packets without the timestamp tag leave the last delay unchanged
+	Time previous = flow.delay.GetLastDelay ();
+	flow.delay.RecordRx (packet);
+	Time delay = flow.delay.GetLastDelay ();
+	if (delay.IsStrictlyPositive () && (delay != previous || !flow.hasDelay))
+	{
+		accounting->m_delay.Add (delay.GetSeconds ());
+		if (flow.hasDelay)
+		{
+			accounting->m_jitter.Add (std::fabs ((delay - flow.lastDelay).GetSeconds ()));
+		}
+		flow.lastDelay = delay;
+		flow.hasDelay = true;
+	}
+}
+
+inline void
+SketchAccounting::Fold (const ActiveFlow& active)
+{
+	//same throughput as FlowAccounting::FillResult
+	FlowResult flow;
+	flow.flowId = active.flowId;
+	flow.rxBytes = active.rxBytes;
+	flow.firstTx = active.firstTx.GetSeconds ();
+	flow.lastRx = active.lastRx.GetSeconds ();
+	flow.type = active.source < m_types.size () ? m_types[active.source] : std::string ();
+	flow.throughput = 0.0;
+	if (flow.lastRx > flow.firstTx)
+	{
+		flow.throughput = (flow.rxBytes * 8.0) / (flow.lastRx - flow.firstTx) / 1024;
+	}
+	m_flows++;
+	m_throughputSum += flow.throughput;
+	m_throughputSquareSum += flow.throughput * flow.throughput;
+	m_rxBytes += flow.rxBytes;
+
+	auto fewerBytes = [] (const FlowResult& a, const FlowResult& b) { return a.rxBytes > b.rxBytes; };
+	if (m_top.size () < m_topFlows)
+	{
+		m_top.push_back (flow);
+		std::push_heap (m_top.begin (), m_top.end (), fewerBytes);
+	}
+	else if (!m_top.empty () && flow.rxBytes > m_top.front ().rxBytes)
+	{
+		std::pop_heap (m_top.begin (), m_top.end (), fewerBytes);
+		m_top.back () = flow;
+		std::push_heap (m_top.begin (), m_top.end (), fewerBytes);
+	}
+}
+
+inline void
+SketchAccounting::Touch (ActiveFlow& flow)
+{
+	flow.lastActivity = Simulator::Now ();
+	m_recent.splice (m_recent.end (), m_recent, flow.recent);
+}
+
+inline void
+SketchAccounting::FoldIdle (void)
+{
+	//the least recently active flows come first, stop at the first one that is not idle
+	Time now = Simulator::Now ();
+	while (!m_recent.empty ())
+	{
+		auto it = m_active.find (m_recent.front ());
+		if (now - it->second.lastActivity < m_idleTimeout)
+		{
+			break;
+		}
+		Fold (it->second);
+		m_active.erase (it);
+		m_recent.pop_front ();
+	}
+	Simulator::Schedule (m_idleTimeout, &SketchAccounting::FoldIdle, this);
+}
+
+inline void
+SketchAccounting::EvictOldest (void)
+{
+	auto oldest = m_active.find (m_recent.front ());
+	Fold (oldest->second);
+	m_active.erase (oldest);
+	m_recent.pop_front ();
+	m_evictions++;
+}
+
+inline void
+SketchAccounting::FillResult (SweepPointResult& result)
+{
+	//fold in the order the flows started so the top flows keep their ids in order
+	std::vector<const ActiveFlow*> remaining;
+	for (const auto& entry : m_active)
+	{
+		remaining.push_back (&entry.second);
+	}
+	std::sort (remaining.begin (), remaining.end (), [] (const ActiveFlow* a, const ActiveFlow* b) { return a->flowId < b->flowId; });
+	for (const ActiveFlow* flow : remaining)
+	{
+		Fold (*flow);
+	}
+	m_active.clear ();
+	m_recent.clear ();
+
+	std::vector<FlowResult> top = m_top;
+	std::sort (top.begin (), top.end (), [] (const FlowResult& a, const FlowResult& b) { return a.flowId < b.flowId; });
+	result.flows.insert (result.flows.end (), top.begin (), top.end ());
+	if (m_flows > 0 && m_throughputSquareSum > 0)
+	{
+		result.avgThroughput = m_throughputSum / m_flows;
+		result.fairness = (m_throughputSum * m_throughputSum) / (m_flows * m_throughputSquareSum);
+	}
+
+	result.metrics["sketchFlows"] = m_flows;
+	result.metrics["sketchTopFlows"] = top.size ();
+	result.metrics["sketchPeakActiveFlows"] = m_peakActive;
+	result.metrics["sketchEvictions"] = m_evictions;
+	result.metrics["sketchSinkOnlyFlows"] = m_sinkOnlyFlows;
+	result.metrics["sketchRxBytes"] = m_rxBytes;
+	//the quantiles are within this relative error unless the sketch had to merge its lowest buckets
+	result.metrics["sketchRelativeError"] = m_delay.GetRelativeAccuracy ();
+	result.metrics["sketchCollapsed"] = m_delay.IsCollapsed () || m_jitter.IsCollapsed ();
+	result.metrics["sketchDelaySamples"] = m_delay.GetCount ();
+	const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+	const char* names[] = {"P50", "P90", "P99", "P999"};
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		result.metrics[std::string ("sketchDelay") + names[i] + "Ms"] = 1000 * m_delay.GetQuantile (quantiles[i]);
+		result.metrics[std::string ("sketchJitter") + names[i] + "Ms"] = 1000 * m_jitter.GetQuantile (quantiles[i]);
+	}
+}
+
+//print the flow counts, delay and jitter percentiles recorded by SketchAccounting::FillResult
+inline void
+PrintSketchMetrics (std::ostream& os, const std::map<std::string, double>& metrics)
+{
+	auto flows = metrics.find ("sketchFlows");
+	if (flows == metrics.end ())
+	{
+		return;
+	}
+	os << "Sketch : " << flows->second << " flow(s), top " << metrics.at ("sketchTopFlows") << " listed, peak "
+	   << metrics.at ("sketchPeakActiveFlows") << " active, " << metrics.at ("sketchEvictions") << " eviction(s), "
+	   << metrics.at ("sketchSinkOnlyFlows") << " flow(s) first seen at a sink\n";
+	os << "Delay p50/p90/p99/p99.9 : " << metrics.at ("sketchDelayP50Ms") << " / " << metrics.at ("sketchDelayP90Ms") << " / "
+	   << metrics.at ("sketchDelayP99Ms") << " / " << metrics.at ("sketchDelayP999Ms") << " ms\n";
+	os << "Jitter p50/p90/p99/p99.9 : " << metrics.at ("sketchJitterP50Ms") << " / " << metrics.at ("sketchJitterP90Ms") << " / "
+	   << metrics.at ("sketchJitterP99Ms") << " / " << metrics.at ("sketchJitterP999Ms") << " ms (+-"
+	   << 100 * metrics.at ("sketchRelativeError") << "%" << (metrics.at ("sketchCollapsed") > 0 ? ", lowest buckets merged" : "") << ")\n";
+}
+
+} // namespace ns3
+
+#endif /* FLOW_SKETCH_H */
@@ -0,0 +1,320 @@
+#ifndef GRID_SPECTRUM_CHANNEL_H
+#define GRID_SPECTRUM_CHANNEL_H
+
+#include "ns3/antenna-module.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/spectrum-module.h"
+
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3
+{
+
+//Spectrum channel that only delivers a frame to the PHYs close enough to the sender to matter.
+//The PHYs are bucketed in a square grid over their x/y positions whose cell size is the
+//interference range: the distance at which a frame sent with MaxTxPower drops below RxCutoff
+//under the propagation loss model (or the Range attribute if it is set). A transmission only
+//visits the 3x3 cells around the sender and skips the PHYs beyond the range, so the cost of a
+//frame depends on the local density instead of the number of PHYs on the channel. The grid is
+//rebuilt lazily after a PHY is added or removed or a mobility model reports a course change.
+//Like SingleModelSpectrumChannel all PHYs must use the same spectrum model.
+class GridSpectrumChannel : public SpectrumChannel
+{
+	public:
+		static TypeId GetTypeId (void)
+		{
+			static TypeId tid = TypeId ("ns3::GridSpectrumChannel")
+				.SetParent<SpectrumChannel> ()
+				.AddConstructor<GridSpectrumChannel> ()
+				.AddAttribute ("RxCutoff", "Received power in dBm below which a frame is not delivered",
+				               DoubleValue (-100.0),
+				               MakeDoubleAccessor (&GridSpectrumChannel::m_rxCutoffDbm),
+				               MakeDoubleChecker<double> ())
+				.AddAttribute ("MaxTxPower", "Highest transmit power in dBm used to derive the range",
+				               DoubleValue (20.0),
+				               MakeDoubleAccessor (&GridSpectrumChannel::m_maxTxPowerDbm),
+				               MakeDoubleChecker<double> ())
+				.AddAttribute ("Range", "Interference range in meters, 0 derives it from RxCutoff and MaxTxPower",
+				               DoubleValue (0.0),
+				               MakeDoubleAccessor (&GridSpectrumChannel::m_rangeAttribute),
+				               MakeDoubleChecker<double> (0.0));
+			return tid;
+		}
+
+		GridSpectrumChannel ()
+		: m_rxCutoffDbm (-100.0),
+		m_maxTxPowerDbm (20.0),
+		m_rangeAttribute (0.0),
+		m_range (0.0),
+		m_dirty (true),
+		m_receivers (0),
+		m_delivered (0)
+		{
+		}
+
+		void AddRx (Ptr<SpectrumPhy> phy) override
+		{
+			m_phys.push_back (phy);
+			m_dirty = true;
+		}
+
+		void RemoveRx (Ptr<SpectrumPhy> phy) override
+		{
+			for (auto it = m_phys.begin (); it != m_phys.end (); it++)
+			{
+				if (*it == phy)
+				{
+					m_phys.erase (it);
+					break;
+				}
+			}
+			m_dirty = true;
+		}
+
+		void StartTx (Ptr<SpectrumSignalParameters> params) override
+		{
+			if (m_dirty)
+			{
+				Rebuild ();
+			}
+			m_receivers += m_phys.size () - 1;
+			Ptr<MobilityModel> senderMobility = params->txPhy->GetMobility ();
+			if (senderMobility == nullptr || std::isinf (m_range))
+			{
+				for (const Ptr<SpectrumPhy>& phy : m_phys)
+				{
+					Deliver (params, senderMobility, phy);
+				}
+				return;
+			}
+
+			//visit the cells around the sender, the cell size is the range so nothing else can be in range
+			Vector position = senderMobility->GetPosition ();
+			int64_t cx = static_cast<int64_t> (std::floor (position.x / m_range));
+			int64_t cy = static_cast<int64_t> (std::floor (position.y / m_range));
+			for (int64_t x = cx - 1; x <= cx + 1; x++)
+			{
+				for (int64_t y = cy - 1; y <= cy + 1; y++)
+				{
+					auto cell = m_cells.find (CellKey (x, y));
+					if (cell == m_cells.end ())
+					{
+						continue;
+					}
+					for (uint32_t index : cell->second)
+					{
+						const Ptr<SpectrumPhy>& phy = m_phys[index];
+						if (senderMobility->GetDistanceFrom (phy->GetMobility ()) > m_range)
+						{
+							continue;
+						}
+						Deliver (params, senderMobility, phy);
+					}
+				}
+			}
+			for (uint32_t index : m_unplaced)
+			{
+				Deliver (params, senderMobility, m_phys[index]);
+			}
+		}
+
+		std::size_t GetNDevices (void) const override
+		{
+			return m_phys.size ();
+		}
+
+		Ptr<NetDevice> GetDevice (std::size_t i) const override
+		{
+			return m_phys[i]->GetDevice ();
+		}
+
+		//interference range in meters, infinite without a propagation loss model
+		double GetRange (void)
+		{
+			if (m_dirty)
+			{
+				Rebuild ();
+			}
+			return m_range;
+		}
+
+		//number of frames scheduled on a receiver and number of receivers skipped for being out of range
+		uint64_t GetDelivered (void) const
+		{
+			return m_delivered;
+		}
+
+		uint64_t GetCulled (void) const
+		{
+			return m_receivers - m_delivered;
+		}
+
+	private:
+		static int64_t CellKey (int64_t x, int64_t y)
+		{
+			return (x << 32) ^ (y & 0xffffffff);
+		}
+
+		static void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
+		{
+			receiver->StartRx (params);
+		}
+
+		//largest distance at which a MaxTxPower frame is still received above RxCutoff
+		double ComputeRange (void)
+		{
+			if (m_rangeAttribute > 0)
+			{
+				return m_rangeAttribute;
+			}
+			if (m_propagationLoss == nullptr)
+			{
+				return std::numeric_limits<double>::infinity ();
+			}
+			//the probes are kept alive so a caching loss model never sees their addresses reused
+			if (m_rangeProbeA == nullptr)
+			{
+				m_rangeProbeA = CreateObject<ConstantPositionMobilityModel> ();
+				m_rangeProbeB = CreateObject<ConstantPositionMobilityModel> ();
+			}
+			m_rangeProbeA->SetPosition (Vector (0, 0, 0));
+			double low = 0.0, high = 1.0;
+			while (high < 1e7 && RxPowerAt (high) >= m_rxCutoffDbm)
+			{
+				high *= 2;
+			}
+			for (uint32_t i = 0; i < 50; i++)
+			{
+				double middle = (low + high) / 2;
+				if (RxPowerAt (middle) >= m_rxCutoffDbm)
+				{
+					low = middle;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+			return high;
+		}
+
+		double RxPowerAt (double distance)
+		{
+			m_rangeProbeB->SetPosition (Vector (distance, 0, 0));
+			return m_propagationLoss->CalcRxPower (m_maxTxPowerDbm, m_rangeProbeA, m_rangeProbeB);
+		}
+
+		//bucket the PHYs by the cell of their position
+		void Rebuild (void)
+		{
+			m_range = ComputeRange ();
+			m_cells.clear ();
+			m_unplaced.clear ();
+			for (uint32_t i = 0; i < m_phys.size (); i++)
+			{
+				Ptr<MobilityModel> mobility = m_phys[i]->GetMobility ();
+				if (mobility == nullptr)
+				{
+					m_unplaced.push_back (i);
+					continue;
+				}
+				if (m_hooked.insert (PeekPointer (mobility)).second)
+				{
+					mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&GridSpectrumChannel::NotifyCourseChange, this));
+				}
+				if (std::isinf (m_range))
+				{
+					continue;
+				}
+				Vector position = mobility->GetPosition ();
+				int64_t x = static_cast<int64_t> (std::floor (position.x / m_range));
+				int64_t y = static_cast<int64_t> (std::floor (position.y / m_range));
+				m_cells[CellKey (x, y)].push_back (i);
+			}
+			m_dirty = false;
+		}
+
+		void NotifyCourseChange (Ptr<const MobilityModel> model)
+		{
+			m_dirty = true;
+		}
+
+		//apply gains, loss and delay like SingleModelSpectrumChannel and schedule the reception
+		void Deliver (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> senderMobility, Ptr<SpectrumPhy> receiver)
+		{
+			if (receiver == txParams->txPhy)
+			{
+				return;
+			}
+			Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+			Time delay = Seconds (0);
+			Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+			if (senderMobility != nullptr && receiverMobility != nullptr)
+			{
+				double pathLossDb = 0;
+				if (txParams->txAntenna != nullptr)
+				{
+					Angles txAngles (receiverMobility->GetPosition (), senderMobility->GetPosition ());
+					pathLossDb -= txParams->txAntenna->GetGainDb (txAngles);
+				}
+				Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel> (receiver->GetAntenna ());
+				if (rxAntenna != nullptr)
+				{
+					Angles rxAngles (senderMobility->GetPosition (), receiverMobility->GetPosition ());
+					pathLossDb -= rxAntenna->GetGainDb (rxAngles);
+				}
+				if (m_propagationLoss != nullptr)
+				{
+					pathLossDb -= m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+				}
+				if (pathLossDb > m_maxLossDb)
+				{
+					return;
+				}
+				*(rxParams->psd) *= std::pow (10.0, -pathLossDb / 10.0);
+				if (m_spectrumPropagationLoss != nullptr)
+				{
+					rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams, senderMobility, receiverMobility);
+				}
+				if (m_propagationDelay != nullptr)
+				{
+					delay = m_propagationDelay->GetDelay (senderMobility, receiverMobility);
+				}
+			}
+			m_delivered++;
+			Ptr<NetDevice> device = receiver->GetDevice ();
+			if (device != nullptr)
+			{
+				Simulator::ScheduleWithContext (device->GetNode ()->GetId (), delay, &GridSpectrumChannel::StartRx, rxParams, receiver);
+			}
+			else
+			{
+				Simulator::Schedule (delay, &GridSpectrumChannel::StartRx, rxParams, receiver);
+			}
+		}
+
+		double m_rxCutoffDbm;
+		double m_maxTxPowerDbm;
+		double m_rangeAttribute;
+		double m_range;
+		bool m_dirty;
+		std::vector<Ptr<SpectrumPhy> > m_phys;
+		std::unordered_map<int64_t, std::vector<uint32_t> > m_cells;
+		std::vector<uint32_t> m_unplaced;                  //phys without mobility, they get every frame
+		std::unordered_set<const MobilityModel*> m_hooked; //mobility models whose course change is traced
+		Ptr<ConstantPositionMobilityModel> m_rangeProbeA;
+		Ptr<ConstantPositionMobilityModel> m_rangeProbeB;
+		uint64_t m_receivers;   //receivers of all frames on a channel without culling
+		uint64_t m_delivered;
+};
+
+} // namespace ns3
+
+#endif /* GRID_SPECTRUM_CHANNEL_H */
@@ -0,0 +1,381 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "ns3/core-module.h"
+#include "ns3/gnuplot.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow-accounting.h"
+#include "result-writer.h"
+
+namespace ns3
+{
+
+//HDR style log-linear histogram of non negative integers (nanoseconds here). Values below
+//2^subBucketBits are counted exactly; above, every power of two is split into 2^(subBucketBits-1)
+//linear sub buckets, so a bucket is never wider than 2^-(subBucketBits-1) of its values. Values
+//from 2^maxExponent on are counted in the last bucket. Recording is a shift and an increment.
+class LogLinearHistogram
+{
+	public:
+		LogLinearHistogram (uint32_t subBucketBits, uint32_t maxExponent);
+
+		void Record (uint64_t value);
+
+		//add the counts of a histogram with the same layout
+		void Add (const LogLinearHistogram& other);
+
+		uint64_t GetCount (void) const;
+		double GetMean (void) const;
+
+		//midpoint of the bucket holding quantile q in [0, 1], 0 if the histogram is empty
+		double GetValueAtQuantile (double q) const;
+
+		//largest relative error of a value taken from a bucket midpoint
+		double GetRelativeError (void) const;
+
+	private:
+		uint32_t GetIndex (uint64_t value) const;
+
+		uint32_t m_subBucketBits;
+		uint64_t m_halfCount;    //2^(subBucketBits - 1) sub buckets per power of two
+		uint64_t m_maxValue;
+		std::vector<uint64_t> m_counts;
+		uint64_t m_count;
+		double m_sum;
+};
+
+inline
+LogLinearHistogram::LogLinearHistogram (uint32_t subBucketBits, uint32_t maxExponent)
+: m_subBucketBits (std::max<uint32_t> (subBucketBits, 2)),
+m_halfCount (1ULL << (m_subBucketBits - 1)),
+m_maxValue ((1ULL << std::max (maxExponent, m_subBucketBits)) - 1),
+m_count (0),
+m_sum (0)
+{
+	m_counts.assign (GetIndex (m_maxValue) + 1, 0);
+}
+
+inline uint32_t
+LogLinearHistogram::GetIndex (uint64_t value) const
+{
+	//bucket b holds [2^(b + subBucketBits - 1), 2^(b + subBucketBits)) in steps of 2^b, with
+	//bucket 0 also holding everything below; the sub bucket is the value shifted by b
+	uint32_t msb = value == 0 ? 0 : 63 - __builtin_clzll (value);
+	uint32_t bucket = msb + 1 > m_subBucketBits ? msb + 1 - m_subBucketBits : 0;
+	return bucket * m_halfCount + (value >> bucket);
+}
+
+inline void
+LogLinearHistogram::Record (uint64_t value)
+{
+	m_counts[GetIndex (std::min (value, m_maxValue))]++;
+	m_count++;
+	m_sum += value;
+}
+
+inline void
+LogLinearHistogram::Add (const LogLinearHistogram& other)
+{
+	NS_ASSERT (other.m_counts.size () == m_counts.size ());
+	for (uint32_t i = 0; i < m_counts.size (); i++)
+	{
+		m_counts[i] += other.m_counts[i];
+	}
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+}
+
+inline uint64_t
+LogLinearHistogram::GetCount (void) const
+{
+	return m_count;
+}
+
+inline double
+LogLinearHistogram::GetMean (void) const
+{
+	return m_count > 0 ? m_sum / m_count : 0.0;
+}
+
+inline double
+LogLinearHistogram::GetValueAtQuantile (double q) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+	uint64_t rank = static_cast<uint64_t> (std::ceil (std::max (0.0, std::min (q, 1.0)) * m_count));
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < m_counts.size (); i++)
+	{
+		seen += m_counts[i];
+		if (seen >= std::max<uint64_t> (rank, 1))
+		{
+			uint32_t bucket = i < 2 * m_halfCount ? 0 : i / m_halfCount - 1;
+			uint64_t sub = i - bucket * m_halfCount;
+			double width = static_cast<double> (1ULL << bucket);
+			return sub * width + (width - 1) / 2;
+		}
+	}
+	return m_maxValue;
+}
+
+inline double
+LogLinearHistogram::GetRelativeError (void) const
+{
+	return 1.0 / (2 * m_halfCount);
+}
+
+//One-way delay and jitter of the flows between source applications and packet sinks, hooked to
+//their "TxWithAddresses" and "RxWithAddresses" traces. The sources put the timestamp byte tag of
+//DelayJitterEstimation on every application packet and the sinks read the one of the first byte
+//of every received packet, so the delay includes the time spent in the tcp send buffer. Jitter
+//is the change of the delay between consecutive packets of a flow (like FlowMonitor's jitterSum).
+//Every flow belongs to a group (its congestion control) with histograms of its own; per-flow
+//histograms can be left out for topologies with many flows.
+class LatencyTracker
+{
+	public:
+		explicit LatencyTracker (bool perFlow);
+
+		//account the packets of a source application as one flow of group, returns its index
+		uint32_t AddSource (Ptr<Application> app, const std::string& group);
+		void AddSink (Ptr<Application> sink);
+
+		//add the mean and the 50/90/99/99.9th percentile of delay and jitter in ms of every flow as
+		//"latency.<group>.flow<index>.*" and of every group as "latency.<group>.*"
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+	private:
+		struct Flow
+		{
+			uint32_t group;
+			bool started;
+			bool hasDelay;
+			Time lastDelay;
+			DelayJitterEstimation estimator;
+		};
+
+		static void NotifyTx (LatencyTracker* tracker, uint32_t flow, Ptr<const Packet> packet, const Address& from, const Address& to);
+		static void NotifyRx (LatencyTracker* tracker, Ptr<const Packet> packet, const Address& from, const Address& to);
+
+		static void AddHistogramMetrics (std::map<std::string, double>& metrics, const std::string& prefix,
+		                                 const LogLinearHistogram& delay, const LogLinearHistogram& jitter);
+
+		//1.6% buckets up to 2^34 ns (17 s), about 15KB per histogram
+		static const uint32_t SUB_BUCKET_BITS = 7;
+		static const uint32_t MAX_EXPONENT = 34;
+
+		bool m_perFlow;
+		std::vector<Flow> m_flows;
+		std::vector<LogLinearHistogram> m_flowDelay;
+		std::vector<LogLinearHistogram> m_flowJitter;
+		std::vector<std::string> m_groups;
+		std::vector<LogLinearHistogram> m_groupDelay;
+		std::vector<LogLinearHistogram> m_groupJitter;
+		std::unordered_map<uint64_t, uint32_t> m_flowByEndpoint;
+};
+
+inline
+LatencyTracker::LatencyTracker (bool perFlow)
+: m_perFlow (perFlow)
+{
+}
+
+inline uint32_t
+LatencyTracker::AddSource (Ptr<Application> app, const std::string& group)
+{
+	uint32_t groupIndex = std::find (m_groups.begin (), m_groups.end (), group) - m_groups.begin ();
+	if (groupIndex == m_groups.size ())
+	{
+		m_groups.push_back (group);
+		m_groupDelay.emplace_back (SUB_BUCKET_BITS, MAX_EXPONENT);
+		m_groupJitter.emplace_back (SUB_BUCKET_BITS, MAX_EXPONENT);
+	}
+	uint32_t flow = m_flows.size ();
+	m_flows.emplace_back ();
+	m_flows.back ().group = groupIndex;
+	m_flows.back ().started = false;
+	m_flows.back ().hasDelay = false;
+	if (m_perFlow)
+	{
+		m_flowDelay.emplace_back (SUB_BUCKET_BITS, MAX_EXPONENT);
+		m_flowJitter.emplace_back (SUB_BUCKET_BITS, MAX_EXPONENT);
+	}
+	app->TraceConnectWithoutContext ("TxWithAddresses", MakeBoundCallback (&LatencyTracker::NotifyTx, this, flow));
+	return flow;
+}
+
+inline void
+LatencyTracker::AddSink (Ptr<Application> sink)
+{
+	sink->TraceConnectWithoutContext ("RxWithAddresses", MakeBoundCallback (&LatencyTracker::NotifyRx, this));
+}
+
+inline void
+LatencyTracker::NotifyTx (LatencyTracker* tracker, uint32_t flow, Ptr<const Packet> packet, const Address& from, const Address& to)
+{
+	if (!tracker->m_flows[flow].started)
+	{
+		tracker->m_flows[flow].started = true;
+		tracker->m_flowByEndpoint[GetEndpointKey (from)] = flow;
+	}
+	DelayJitterEstimation::PrepareTx (packet);
+}
+
+inline void
+LatencyTracker::NotifyRx (LatencyTracker* tracker, Ptr<const Packet> packet, const Address& from, const Address& to)
+{
+	auto it = tracker->m_flowByEndpoint.find (GetEndpointKey (from));
+	if (it == tracker->m_flowByEndpoint.end ())
+	{
+		return;
+	}
+	//packets without the timestamp tag leave the last delay unchanged
+	Flow& flow = tracker->m_flows[it->second];
+	Time previous = flow.estimator.GetLastDelay ();
+	flow.estimator.RecordRx (packet);
+	Time delay = flow.estimator.GetLastDelay ();
+	if (!delay.IsStrictlyPositive () || (flow.hasDelay && delay == previous))
+	{
+		return;
+	}
+	uint64_t delayNs = delay.GetNanoSeconds ();
+	tracker->m_groupDelay[flow.group].Record (delayNs);
+	if (tracker->m_perFlow)
+	{
+		tracker->m_flowDelay[it->second].Record (delayNs);
+	}
+	if (flow.hasDelay)
+	{
+		uint64_t jitterNs = std::abs ((delay - flow.lastDelay).GetNanoSeconds ());
+		tracker->m_groupJitter[flow.group].Record (jitterNs);
+		if (tracker->m_perFlow)
+		{
+			tracker->m_flowJitter[it->second].Record (jitterNs);
+		}
+	}
+	flow.lastDelay = delay;
+	flow.hasDelay = true;
+}
+
+inline void
+LatencyTracker::AddHistogramMetrics (std::map<std::string, double>& metrics, const std::string& prefix,
+                                     const LogLinearHistogram& delay, const LogLinearHistogram& jitter)
+{
+	const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+	const char* names[] = {"P50", "P90", "P99", "P999"};
+	metrics[prefix + "packets"] = delay.GetCount ();
+	metrics[prefix + "delayMeanMs"] = delay.GetMean () / 1e6;
+	metrics[prefix + "jitterMeanMs"] = jitter.GetMean () / 1e6;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		metrics[prefix + "delay" + names[i] + "Ms"] = delay.GetValueAtQuantile (quantiles[i]) / 1e6;
+		metrics[prefix + "jitter" + names[i] + "Ms"] = jitter.GetValueAtQuantile (quantiles[i]) / 1e6;
+	}
+}
+
+inline void
+LatencyTracker::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	for (uint32_t group = 0; group < m_groups.size (); group++)
+	{
+		AddHistogramMetrics (metrics, "latency." + m_groups[group] + ".", m_groupDelay[group], m_groupJitter[group]);
+	}
+	for (uint32_t flow = 0; m_perFlow && flow < m_flows.size (); flow++)
+	{
+		AddHistogramMetrics (metrics, "latency." + m_groups[m_flows[flow].group] + ".flow" + std::to_string (flow) + ".",
+		                     m_flowDelay[flow], m_flowJitter[flow]);
+	}
+	if (!m_groups.empty ())
+	{
+		metrics["latencyRelativeError"] = m_groupDelay[0].GetRelativeError ();
+	}
+}
+
+//group names of the latency metrics of a sweep point, e.g. the congestion control types
+inline std::vector<std::string>
+GetLatencyGroups (const std::map<std::string, double>& metrics)
+{
+	std::vector<std::string> groups;
+	for (auto it = metrics.lower_bound ("latency."); it != metrics.end () && it->first.compare (0, 8, "latency.") == 0; it++)
+	{
+		std::string subject = it->first.substr (8, it->first.rfind ('.') - 8);
+		if (subject.find ('.') == std::string::npos && it->first.compare (it->first.size () - 7, 7, "packets") == 0)
+		{
+			groups.push_back (subject);
+		}
+	}
+	return groups;
+}
+
+//print the delay and jitter percentiles recorded by LatencyTracker::AddMetrics, one line per
+//group and flow
+inline void
+PrintLatencyMetrics (std::ostream& os, const std::map<std::string, double>& metrics)
+{
+	auto error = metrics.find ("latencyRelativeError");
+	if (error == metrics.end ())
+	{
+		return;
+	}
+	os << "One-way delay / jitter p50 p90 p99 p99.9 (ms, +-" << 100 * error->second << "%) :\n";
+	for (auto it = metrics.lower_bound ("latency."); it != metrics.end () && it->first.compare (0, 8, "latency.") == 0; it++)
+	{
+		if (it->first.size () < 8 || it->first.compare (it->first.size () - 7, 7, "packets") != 0)
+		{
+			continue;
+		}
+		std::string prefix = it->first.substr (0, it->first.size () - 7);
+		os << prefix.substr (8, prefix.size () - 9) << "\t" << metrics.at (prefix + "delayP50Ms") << " "
+		   << metrics.at (prefix + "delayP90Ms") << " " << metrics.at (prefix + "delayP99Ms") << " "
+		   << metrics.at (prefix + "delayP999Ms") << " / " << metrics.at (prefix + "jitterP50Ms") << " "
+		   << metrics.at (prefix + "jitterP90Ms") << " " << metrics.at (prefix + "jitterP99Ms") << " "
+		   << metrics.at (prefix + "jitterP999Ms") << "\n";
+	}
+}
+
+//write <fileNameWithNoExtension>.plt plotting the p50 and p99 one-way delay of every group
+//against the packet size, from the latency metrics of the points of a writer
+inline void
+WriteLatencyPlot (const ResultWriter& writer, const std::string& fileNameWithNoExtension)
+{
+	if (writer.GetPoints ().empty ())
+	{
+		return;
+	}
+	Gnuplot plot (fileNameWithNoExtension + ".png");
+	plot.SetTitle ("One-Way Delay Vs Packet Size");
+	plot.SetTerminal ("png");
+	plot.SetLegend ("Packet Size(Bytes)", "Delay(ms)");
+	plot.AppendExtra ("set xrange [0:1500]");
+	plot.AppendExtra ("set logscale y");
+	for (const std::string& group : GetLatencyGroups (writer.GetPoints ()[0].metrics))
+	{
+		const char* quantiles[] = {"P50", "P99"};
+		for (const char* quantile : quantiles)
+		{
+			Gnuplot2dDataset dataset;
+			dataset.SetTitle (group + " " + std::string (quantile).substr (1) + "th");
+			dataset.SetStyle (Gnuplot2dDataset::LINES_POINTS);
+			writer.FillDataset (dataset, "latency." + group + ".delay" + quantile + "Ms");
+			plot.AddDataset (dataset);
+		}
+	}
+	std::ofstream plotFile ((fileNameWithNoExtension + ".plt").c_str ());
+	plot.GenerateOutput (plotFile);
+}
+
+} // namespace ns3
+
+#endif /* LATENCY_HISTOGRAM_H */
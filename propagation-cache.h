@@ -0,0 +1,246 @@
+#ifndef PROPAGATION_CACHE_H
+#define PROPAGATION_CACHE_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/propagation-module.h"
+
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+//Pairwise matrix of a value (path loss or delay) between mobility models. Every model gets a
+//dense index the first time it is seen and its "CourseChange" trace is hooked, so the row and
+//column of a model are only thrown away when it actually moves. Entries not computed yet are
+//NaN and are filled by the compute function on the first lookup.
+class PropagationPairCache
+{
+	public:
+		PropagationPairCache ();
+
+		//return the value of the pair (a, b), calling compute () if it is not cached
+		template <typename Compute>
+		double Get (Ptr<MobilityModel> a, Ptr<MobilityModel> b, Compute compute);
+
+		uint64_t GetHits (void) const;
+		uint64_t GetMisses (void) const;
+		uint64_t GetInvalidations (void) const;
+
+	private:
+		//index of a model, adding it and hooking its course change trace if it is new
+		uint32_t GetIndex (Ptr<MobilityModel> model);
+
+		//forget the row and the column of a model that moved
+		void NotifyCourseChange (Ptr<const MobilityModel> model);
+
+		std::unordered_map<const MobilityModel*, uint32_t> m_index;
+		std::vector<std::vector<double> > m_matrix;   //rows grow on demand up to the number of models
+		uint64_t m_hits;
+		uint64_t m_misses;
+		uint64_t m_invalidations;
+};
+
+inline
+PropagationPairCache::PropagationPairCache ()
+: m_hits (0),
+m_misses (0),
+m_invalidations (0)
+{
+}
+
+inline uint32_t
+PropagationPairCache::GetIndex (Ptr<MobilityModel> model)
+{
+	auto it = m_index.find (PeekPointer (model));
+	if (it != m_index.end ())
+	{
+		return it->second;
+	}
+	uint32_t index = m_matrix.size ();
+	m_index[PeekPointer (model)] = index;
+	m_matrix.emplace_back ();
+	model->TraceConnectWithoutContext ("CourseChange", MakeCallback (&PropagationPairCache::NotifyCourseChange, this));
+	return index;
+}
+
+template <typename Compute>
+inline double
+PropagationPairCache::Get (Ptr<MobilityModel> a, Ptr<MobilityModel> b, Compute compute)
+{
+	uint32_t i = GetIndex (a);
+	uint32_t j = GetIndex (b);
+	std::vector<double>& row = m_matrix[i];
+	if (j >= row.size ())
+	{
+		row.resize (m_matrix.size (), std::numeric_limits<double>::quiet_NaN ());
+	}
+	if (std::isnan (row[j]))
+	{
+		m_misses++;
+		row[j] = compute ();
+	}
+	else
+	{
+		m_hits++;
+	}
+	return row[j];
+}
+
+inline void
+PropagationPairCache::NotifyCourseChange (Ptr<const MobilityModel> model)
+{
+	auto it = m_index.find (PeekPointer (model));
+	if (it == m_index.end ())
+	{
+		return;
+	}
+	uint32_t index = it->second;
+	m_invalidations++;
+	m_matrix[index].clear ();
+	for (std::vector<double>& row : m_matrix)
+	{
+		if (index < row.size ())
+		{
+			row[index] = std::numeric_limits<double>::quiet_NaN ();
+		}
+	}
+}
+
+inline uint64_t
+PropagationPairCache::GetHits (void) const
+{
+	return m_hits;
+}
+
+inline uint64_t
+PropagationPairCache::GetMisses (void) const
+{
+	return m_misses;
+}
+
+inline uint64_t
+PropagationPairCache::GetInvalidations (void) const
+{
+	return m_invalidations;
+}
+
+//Serves the path loss of a deterministic loss model (log-distance, Friis, ...) from a
+//PropagationPairCache. The loss in dB does not depend on the tx power, so it is cached per
+//pair and subtracted from the tx power of every packet. Random loss models (fading) must not
+//be wrapped since every packet would see the same sample.
+class CachedPropagationLossModel : public PropagationLossModel
+{
+	public:
+		static TypeId GetTypeId (void)
+		{
+			static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+				.SetParent<PropagationLossModel> ()
+				.AddConstructor<CachedPropagationLossModel> ();
+			return tid;
+		}
+
+		//model whose results are cached
+		void SetModel (Ptr<PropagationLossModel> model)
+		{
+			m_model = model;
+		}
+
+		//compute the loss of every pair of nodes before the simulation starts
+		void Precompute (const NodeContainer& nodes)
+		{
+			for (uint32_t i = 0; i < nodes.GetN (); i++)
+			{
+				for (uint32_t j = 0; j < nodes.GetN (); j++)
+				{
+					if (i != j)
+					{
+						DoCalcRxPower (0.0, nodes.Get (i)->GetObject<MobilityModel> (), nodes.Get (j)->GetObject<MobilityModel> ());
+					}
+				}
+			}
+		}
+
+		const PropagationPairCache& GetCache (void) const
+		{
+			return m_cache;
+		}
+
+	private:
+		double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override
+		{
+			double loss = m_cache.Get (a, b, [&] () { return -m_model->CalcRxPower (0.0, a, b); });
+			return txPowerDbm - loss;
+		}
+
+		int64_t DoAssignStreams (int64_t stream) override
+		{
+			return m_model->AssignStreams (stream);
+		}
+
+		Ptr<PropagationLossModel> m_model;
+		mutable PropagationPairCache m_cache;
+};
+
+//Serves the delay of a propagation delay model from a PropagationPairCache.
+class CachedPropagationDelayModel : public PropagationDelayModel
+{
+	public:
+		static TypeId GetTypeId (void)
+		{
+			static TypeId tid = TypeId ("ns3::CachedPropagationDelayModel")
+				.SetParent<PropagationDelayModel> ()
+				.AddConstructor<CachedPropagationDelayModel> ();
+			return tid;
+		}
+
+		//model whose results are cached
+		void SetModel (Ptr<PropagationDelayModel> model)
+		{
+			m_model = model;
+		}
+
+		//compute the delay of every pair of nodes before the simulation starts
+		void Precompute (const NodeContainer& nodes)
+		{
+			for (uint32_t i = 0; i < nodes.GetN (); i++)
+			{
+				for (uint32_t j = 0; j < nodes.GetN (); j++)
+				{
+					if (i != j)
+					{
+						GetDelay (nodes.Get (i)->GetObject<MobilityModel> (), nodes.Get (j)->GetObject<MobilityModel> ());
+					}
+				}
+			}
+		}
+
+		Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override
+		{
+			//delays are cached as time steps, exact up to 2^53 steps
+			double steps = m_cache.Get (a, b, [&] () { return static_cast<double> (m_model->GetDelay (a, b).GetTimeStep ()); });
+			return TimeStep (static_cast<uint64_t> (steps));
+		}
+
+		const PropagationPairCache& GetCache (void) const
+		{
+			return m_cache;
+		}
+
+	private:
+		int64_t DoAssignStreams (int64_t stream) override
+		{
+			return m_model->AssignStreams (stream);
+		}
+
+		Ptr<PropagationDelayModel> m_model;
+		mutable PropagationPairCache m_cache;
+};
+
+} // namespace ns3
+
+#endif /* PROPAGATION_CACHE_H */
@@ -0,0 +1,305 @@
+#ifndef QUEUE_MONITOR_H
+#define QUEUE_MONITOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+//Instruments the transmit side of a point-to-point device through the Enqueue, Dequeue and
+//Drop traces of its queue and of the root queue disc installed on it (pfifo_fast once an ipv4
+//address is assigned). With flow control the device queue is stopped before it overflows, so
+//most of the waiting and the tail drops happen in the queue disc; both are monitored as one
+//queue from the queue disc enqueue to the device dequeue. It keeps two fixed bucket histograms
+//and a drop counter per flow:
+//- occupancy: time spent with the queues holding a given number of bytes (time weighted)
+//- sojourn: number of packets that waited a given time between enqueue and dequeue
+//- drops: packets dropped by either queue, keyed by the tcp/udp source port of the flow
+//Queues in this repo are FIFO, so the enqueue times are kept in a deque instead of being
+//looked up by packet uid. Every trace does a constant amount of work.
+class QueueMonitor
+{
+	public:
+		//occupancy buckets of occupancyBucketBytes and sojourn buckets of sojournBucket,
+		//values beyond the last bucket are counted in it
+		QueueMonitor (uint32_t occupancyBucketBytes, uint32_t occupancyBuckets, Time sojournBucket, uint32_t sojournBuckets);
+
+		//hook the traces of the transmit queue and root queue disc of device, call once the ipv4
+		//addresses are assigned
+		void Install (Ptr<PointToPointNetDevice> device);
+
+		//close the last occupancy interval at the end of the run and add the histograms, means,
+		//percentiles and drop counters to the metrics of a sweep point
+		void AddMetrics (std::map<std::string, double>& metrics);
+
+	private:
+		void NotifyEnqueue (Ptr<const Packet> packet);
+		void NotifyDiscEnqueue (Ptr<const QueueDiscItem> item);
+		void NotifyDequeue (Ptr<const Packet> packet);
+		void NotifyDrop (Ptr<const Packet> packet);
+		void NotifyDiscDrop (Ptr<const QueueDiscItem> item);
+
+		//account the time since the last change at the previous occupancy
+		void UpdateOccupancy (void);
+
+		//bytes held by the device queue and the queue disc
+		uint32_t GetNBytes (void) const;
+
+		//source port of a packet carrying a ppp, ipv4 and tcp or udp header, 0 if unknown
+		static uint16_t GetSourcePort (Ptr<const Packet> packet);
+
+		//source port of a tcp or udp packet without its ip header, 0 if unknown
+		static uint16_t GetTransportSourcePort (uint8_t protocol, Ptr<const Packet> packet);
+
+		Ptr<Queue<Packet> > m_queue;
+		Ptr<QueueDisc> m_queueDisc;
+		uint32_t m_occupancyBucketBytes;
+		std::vector<double> m_occupancySeconds;
+		int64_t m_sojournBucketNs;
+		std::vector<uint64_t> m_sojournCount;
+		std::deque<Time> m_enqueueTimes;
+		Time m_lastChange;
+		uint32_t m_lastBytes;
+		uint32_t m_maxBytes;
+		double m_byteSeconds;
+		double m_sojournSumSeconds;
+		uint64_t m_enqueued;
+		uint64_t m_dequeued;
+		std::map<uint16_t, uint64_t> m_drops;
+};
+
+inline
+QueueMonitor::QueueMonitor (uint32_t occupancyBucketBytes, uint32_t occupancyBuckets, Time sojournBucket, uint32_t sojournBuckets)
+: m_occupancyBucketBytes (std::max<uint32_t> (occupancyBucketBytes, 1)),
+m_occupancySeconds (std::max<uint32_t> (occupancyBuckets, 1), 0.0),
+m_sojournBucketNs (std::max<int64_t> (sojournBucket.GetNanoSeconds (), 1)),
+m_sojournCount (std::max<uint32_t> (sojournBuckets, 1), 0),
+m_lastChange (Seconds (0)),
+m_lastBytes (0),
+m_maxBytes (0),
+m_byteSeconds (0),
+m_sojournSumSeconds (0),
+m_enqueued (0),
+m_dequeued (0)
+{
+}
+
+inline void
+QueueMonitor::Install (Ptr<PointToPointNetDevice> device)
+{
+	m_queue = device->GetQueue ();
+	Ptr<TrafficControlLayer> tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+	if (tc != nullptr)
+	{
+		m_queueDisc = tc->GetRootQueueDiscOnDevice (device);
+	}
+	m_lastChange = Simulator::Now ();
+	m_lastBytes = GetNBytes ();
+	if (m_queueDisc != nullptr)
+	{
+		//packets enter at the queue disc and move to the device queue without changing the total
+		m_queueDisc->TraceConnectWithoutContext ("Enqueue", MakeCallback (&QueueMonitor::NotifyDiscEnqueue, this));
+		m_queueDisc->TraceConnectWithoutContext ("Drop", MakeCallback (&QueueMonitor::NotifyDiscDrop, this));
+	}
+	else
+	{
+		m_queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&QueueMonitor::NotifyEnqueue, this));
+	}
+	m_queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&QueueMonitor::NotifyDequeue, this));
+	m_queue->TraceConnectWithoutContext ("Drop", MakeCallback (&QueueMonitor::NotifyDrop, this));
+}
+
+inline uint32_t
+QueueMonitor::GetNBytes (void) const
+{
+	return m_queue->GetNBytes () + (m_queueDisc != nullptr ? m_queueDisc->GetNBytes () : 0);
+}
+
+inline void
+QueueMonitor::UpdateOccupancy (void)
+{
+	Time now = Simulator::Now ();
+	double seconds = (now - m_lastChange).GetSeconds ();
+	uint32_t bucket = std::min<uint32_t> (m_lastBytes / m_occupancyBucketBytes, m_occupancySeconds.size () - 1);
+	m_occupancySeconds[bucket] += seconds;
+	m_byteSeconds += seconds * m_lastBytes;
+	m_lastChange = now;
+	m_lastBytes = GetNBytes ();
+	m_maxBytes = std::max (m_maxBytes, m_lastBytes);
+}
+
+inline void
+QueueMonitor::NotifyEnqueue (Ptr<const Packet> packet)
+{
+	UpdateOccupancy ();
+	m_enqueueTimes.push_back (Simulator::Now ());
+	m_enqueued++;
+}
+
+inline void
+QueueMonitor::NotifyDiscEnqueue (Ptr<const QueueDiscItem> item)
+{
+	UpdateOccupancy ();
+	m_enqueueTimes.push_back (Simulator::Now ());
+	m_enqueued++;
+}
+
+inline void
+QueueMonitor::NotifyDequeue (Ptr<const Packet> packet)
+{
+	UpdateOccupancy ();
+	if (m_enqueueTimes.empty ())
+	{
+		return;
+	}
+	Time sojourn = Simulator::Now () - m_enqueueTimes.front ();
+	m_enqueueTimes.pop_front ();
+	uint64_t bucket = std::min<uint64_t> (sojourn.GetNanoSeconds () / m_sojournBucketNs, m_sojournCount.size () - 1);
+	m_sojournCount[bucket]++;
+	m_sojournSumSeconds += sojourn.GetSeconds ();
+	m_dequeued++;
+}
+
+inline void
+QueueMonitor::NotifyDrop (Ptr<const Packet> packet)
+{
+	//a tail drop happens before the packet is enqueued, the occupancy does not change
+	m_drops[GetSourcePort (packet)]++;
+	if (m_queueDisc != nullptr)
+	{
+		//the packet left the queue disc and was counted, its enqueue time is the one behind
+		//those of the packets still in the device queue
+		UpdateOccupancy ();
+		uint32_t index = m_queue->GetNPackets ();
+		if (index < m_enqueueTimes.size ())
+		{
+			m_enqueueTimes.erase (m_enqueueTimes.begin () + index);
+		}
+	}
+}
+
+inline void
+QueueMonitor::NotifyDiscDrop (Ptr<const QueueDiscItem> item)
+{
+	//pfifo_fast only drops before enqueue, the occupancy does not change
+	Ptr<const Ipv4QueueDiscItem> ipv4 = DynamicCast<const Ipv4QueueDiscItem> (item);
+	m_drops[ipv4 != nullptr ? GetTransportSourcePort (ipv4->GetHeader ().GetProtocol (), item->GetPacket ()) : 0]++;
+}
+
+inline uint16_t
+QueueMonitor::GetSourcePort (Ptr<const Packet> packet)
+{
+	Ptr<Packet> copy = packet->Copy ();
+	PppHeader ppp;
+	Ipv4Header ip;
+	if (copy->RemoveHeader (ppp) == 0 || ppp.GetProtocol () != 0x0021 || copy->RemoveHeader (ip) == 0)
+	{
+		return 0;
+	}
+	return GetTransportSourcePort (ip.GetProtocol (), copy);
+}
+
+inline uint16_t
+QueueMonitor::GetTransportSourcePort (uint8_t protocol, Ptr<const Packet> packet)
+{
+	if (protocol == TcpL4Protocol::PROT_NUMBER)
+	{
+		TcpHeader tcp;
+		packet->PeekHeader (tcp);
+		return tcp.GetSourcePort ();
+	}
+	if (protocol == UdpL4Protocol::PROT_NUMBER)
+	{
+		UdpHeader udp;
+		packet->PeekHeader (udp);
+		return udp.GetSourcePort ();
+	}
+	return 0;
+}
+
+inline void
+QueueMonitor::AddMetrics (std::map<std::string, double>& metrics)
+{
+	UpdateOccupancy ();
+	double totalSeconds = 0;
+	for (double seconds : m_occupancySeconds)
+	{
+		totalSeconds += seconds;
+	}
+	metrics["queueOccupancyMeanBytes"] = totalSeconds > 0 ? m_byteSeconds / totalSeconds : 0.0;
+	metrics["queueOccupancyMaxBytes"] = m_maxBytes;
+	metrics["queueOccupancyBucketBytes"] = m_occupancyBucketBytes;
+	for (uint32_t i = 0; i < m_occupancySeconds.size (); i++)
+	{
+		metrics["queueOccupancyHist." + std::to_string (i)] = totalSeconds > 0 ? m_occupancySeconds[i] / totalSeconds : 0.0;
+	}
+
+	metrics["queueSojournMeanMs"] = m_dequeued > 0 ? 1000 * m_sojournSumSeconds / m_dequeued : 0.0;
+	metrics["queueSojournBucketMs"] = m_sojournBucketNs / 1e6;
+	uint64_t seen = 0;
+	double p99 = 0;
+	for (uint32_t i = 0; i < m_sojournCount.size (); i++)
+	{
+		metrics["queueSojournHist." + std::to_string (i)] = m_sojournCount[i];
+		seen += m_sojournCount[i];
+		if (p99 == 0 && seen >= 0.99 * m_dequeued && m_dequeued > 0)
+		{
+			//upper edge of the bucket holding the 99th percentile
+			p99 = (i + 1) * m_sojournBucketNs / 1e6;
+		}
+	}
+	metrics["queueSojournP99Ms"] = p99;
+
+	uint64_t drops = 0;
+	for (const auto& flow : m_drops)
+	{
+		metrics["queueDrops.port" + std::to_string (flow.first)] = flow.second;
+		drops += flow.second;
+	}
+	metrics["queueEnqueued"] = m_enqueued;
+	metrics["queueDrops"] = drops;
+}
+
+//print the queue statistics of a sweep point recorded by QueueMonitor::AddMetrics
+inline void
+PrintQueueMetrics (std::ostream& os, const std::map<std::string, double>& metrics)
+{
+	auto mean = metrics.find ("queueOccupancyMeanBytes");
+	if (mean == metrics.end ())
+	{
+		return;
+	}
+	os << "Bottleneck Queue : mean " << mean->second << " B, max " << metrics.at ("queueOccupancyMaxBytes")
+	   << " B, sojourn mean " << metrics.at ("queueSojournMeanMs") << " ms, p99 <= " << metrics.at ("queueSojournP99Ms")
+	   << " ms, " << metrics.at ("queueDrops") << " drop(s) of " << metrics.at ("queueEnqueued") + metrics.at ("queueDrops") << "\n";
+	os << "Occupancy (fraction of time per " << metrics.at ("queueOccupancyBucketBytes") << " B) :";
+	for (uint32_t i = 0; metrics.count ("queueOccupancyHist." + std::to_string (i)) > 0; i++)
+	{
+		os << " " << metrics.at ("queueOccupancyHist." + std::to_string (i));
+	}
+	os << "\nSojourn (packets per " << metrics.at ("queueSojournBucketMs") << " ms) :";
+	for (uint32_t i = 0; metrics.count ("queueSojournHist." + std::to_string (i)) > 0; i++)
+	{
+		os << " " << metrics.at ("queueSojournHist." + std::to_string (i));
+	}
+	os << "\nDrops per source port :";
+	for (auto it = metrics.lower_bound ("queueDrops.port"); it != metrics.end () && it->first.compare (0, 15, "queueDrops.port") == 0; it++)
+	{
+		os << " " << it->first.substr (15) << "=" << it->second;
+	}
+	os << "\n";
+}
+
+} // namespace ns3
+
+#endif /* QUEUE_MONITOR_H */
@@ -0,0 +1,154 @@
+#ifndef REPLICATION_STATS_H
+#define REPLICATION_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//sample mean, standard deviation and 95% confidence interval of a set of replications
+struct SampleSummary
+{
+	uint32_t n;
+	double mean;
+	double stddev;
+	double ciHalfWidth;  //half width of the 95% confidence interval of the mean
+
+	SampleSummary ()
+	: n (0),
+	mean (0.0),
+	stddev (0.0),
+	ciHalfWidth (0.0)
+	{
+	}
+};
+
+//replication summary of one packet size
+struct ReplicationSummary
+{
+	uint32_t packetSize;
+	SampleSummary throughput;
+	SampleSummary fairness;
+};
+
+//two sided 95% quantile of the student t distribution with df degrees of freedom
+inline double
+StudentT95 (uint32_t df)
+{
+	static const double table[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+	if (df == 0)
+	{
+		return 0.0;
+	}
+	if (df <= 30)
+	{
+		return table[df - 1];
+	}
+	if (df <= 60)
+	{
+		return 2.000;
+	}
+	if (df <= 120)
+	{
+		return 1.980;
+	}
+	return 1.960;
+}
+
+//compute mean, sample standard deviation and the 95% confidence interval of the samples
+inline SampleSummary
+Summarize (const std::vector<double>& samples)
+{
+	SampleSummary s;
+	s.n = samples.size ();
+	if (s.n == 0)
+	{
+		return s;
+	}
+	for (double x : samples)
+	{
+		s.mean += x;
+	}
+	s.mean /= s.n;
+	if (s.n > 1)
+	{
+		double sq = 0.0;
+		for (double x : samples)
+		{
+			sq += (x - s.mean) * (x - s.mean);
+		}
+		s.stddev = std::sqrt (sq / (s.n - 1));
+		s.ciHalfWidth = StudentT95 (s.n - 1) * s.stddev / std::sqrt (static_cast<double> (s.n));
+	}
+	return s;
+}
+
+//estimate the number of replications needed for the confidence interval half width
+//to be within "relativeTarget" (e.g. 0.05 for +-5%) of the mean, using the normal quantile
+inline uint32_t
+RequiredReplications (const SampleSummary& s, double relativeTarget)
+{
+	if (s.n < 2 || s.mean == 0.0 || relativeTarget <= 0.0)
+	{
+		return s.n;
+	}
+	double n = std::pow (1.960 * s.stddev / (relativeTarget * std::fabs (s.mean)), 2.0);
+	return std::max<uint32_t> (2, static_cast<uint32_t> (std::ceil (n)));
+}
+
+//group the replicated sweep results by packet size and summarize throughput and fairness,
+//failed runs are left out of the summary
+inline std::vector<ReplicationSummary>
+SummarizeReplications (const std::vector<SweepPointResult>& results)
+{
+	std::map<uint32_t, std::vector<double> > throughput, fairness;
+	for (const SweepPointResult& result : results)
+	{
+		if (!result.ok)
+		{
+			continue;
+		}
+		throughput[result.packetSize].push_back (result.avgThroughput);
+		fairness[result.packetSize].push_back (result.fairness);
+	}
+	std::vector<ReplicationSummary> summaries;
+	for (const auto& entry : throughput)
+	{
+		ReplicationSummary summary;
+		summary.packetSize = entry.first;
+		summary.throughput = Summarize (entry.second);
+		summary.fairness = Summarize (fairness[entry.first]);
+		summaries.push_back (summary);
+	}
+	return summaries;
+}
+
+//print the replication summary of one packet size, including the number of replications
+//needed to reach the requested relative confidence interval width
+inline void
+PrintReplicationSummary (std::ostream& os, const ReplicationSummary& summary, double relativeTarget)
+{
+	os << "Packet-Size : " << summary.packetSize << " (" << summary.throughput.n << " runs)" << std::endl;
+	os << "Average Throughput: " << summary.throughput.mean << " Kbps"
+	   << " stddev " << summary.throughput.stddev
+	   << " 95% CI +-" << summary.throughput.ciHalfWidth << std::endl;
+	os << "FairnessIndex: " << summary.fairness.mean
+	   << " stddev " << summary.fairness.stddev
+	   << " 95% CI +-" << summary.fairness.ciHalfWidth << std::endl;
+	os << "Runs needed for +-" << relativeTarget * 100 << "% CI : throughput "
+	   << RequiredReplications (summary.throughput, relativeTarget)
+	   << ", fairness " << RequiredReplications (summary.fairness, relativeTarget) << std::endl;
+	os << "---------------------------------------------------------" << std::endl << std::endl;
+}
+
+} // namespace ns3
+
+#endif /* REPLICATION_STATS_H */
@@ -0,0 +1,283 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "ns3/core-module.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "sweep-runner.h"
+
+//version header ns-3 generates when configured with --enable-build-version
+#if !defined(RESULT_CACHE_NS3_VERSION) && defined(__has_include)
+#if __has_include("ns3/version-defines.h")
+#include "ns3/version-defines.h"
+#endif
+#endif
+
+namespace ns3
+{
+
+//Description of everything a sweep point result depends on, built from name=value pairs.
+//Its hash names the cache entry, so any changed value selects a different entry.
+class ResultKey
+{
+	public:
+		ResultKey ();
+
+		template <typename T>
+		ResultKey& Add (const std::string& name, const T& value);
+
+		//add the contents of an input file, so editing the file selects a new entry
+		ResultKey& AddFile (const std::string& name, const std::string& fileName);
+
+		//the description and its 64 bit FNV-1a hash as 16 hex digits
+		const std::string& GetDescription (void) const;
+		std::string GetHash (void) const;
+
+	private:
+		std::string m_description;
+};
+
+//ns-3 build the program runs with, part of every cache key so results of another release are
+//never reused: the tag and commit of the version header if ns-3 generated one, and the file name
+//(libns3.<release>-core-<profile>.so) and size of the core library mapped into the process.
+//-DRESULT_CACHE_NS3_VERSION=\"...\" replaces both, e.g. for static builds.
+inline std::string
+GetNs3BuildVersion (void)
+{
+#ifdef RESULT_CACHE_NS3_VERSION
+	return RESULT_CACHE_NS3_VERSION;
+#else
+	static std::string version;
+	if (!version.empty ())
+	{
+		return version;
+	}
+	std::ostringstream os;
+#ifdef NS3_VERSION_TAG
+	os << NS3_VERSION_TAG << "+" << NS3_VERSION_COMMIT_HASH << " ";
+#endif
+	std::ifstream maps ("/proc/self/maps");
+	std::string line;
+	while (std::getline (maps, line))
+	{
+		size_t path = line.find ('/');
+		if (path == std::string::npos)
+		{
+			continue;
+		}
+		std::string file = line.substr (path);
+		std::string name = file.substr (file.rfind ('/') + 1);
+		struct stat info;
+		if (name.compare (0, 6, "libns3") == 0 && name.find ("-core") != std::string::npos && stat (file.c_str (), &info) == 0)
+		{
+			os << name << " " << info.st_size;
+			break;
+		}
+	}
+	version = os.str ();
+	if (version.empty ())
+	{
+		version = "unknown";
+	}
+	return version;
+#endif
+}
+
+inline
+ResultKey::ResultKey ()
+{
+	Add ("ns3", GetNs3BuildVersion ());
+}
+
+template <typename T>
+inline ResultKey&
+ResultKey::Add (const std::string& name, const T& value)
+{
+	std::ostringstream os;
+	os << std::setprecision (17) << name << "=" << value << ";";
+	m_description += os.str ();
+	return *this;
+}
+
+inline ResultKey&
+ResultKey::AddFile (const std::string& name, const std::string& fileName)
+{
+	std::ifstream file (fileName.c_str ());
+	std::ostringstream contents;
+	contents << file.rdbuf ();
+	ResultKey contentKey;
+	contentKey.m_description = contents.str ();
+	return Add (name, fileName + "#" + contentKey.GetHash ());
+}
+
+inline const std::string&
+ResultKey::GetDescription (void) const
+{
+	return m_description;
+}
+
+inline std::string
+ResultKey::GetHash (void) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned char c : m_description)
+	{
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	std::ostringstream os;
+	os << std::hex << std::setw (16) << std::setfill ('0') << hash;
+	return os.str ();
+}
+
+//On-disk cache of sweep point results: <directory>/<hash>.point holds the key description on
+//its first line and the result in the text format of SerializeSweepPoint after it. The
+//description is compared on load, so a hash collision is a miss and not a wrong result.
+class ResultCache
+{
+	public:
+		explicit ResultCache (const std::string& directory);
+
+		bool Load (const ResultKey& key, SweepPointResult& result);
+		void Store (const ResultKey& key, const SweepPointResult& result);
+
+		uint32_t GetHits (void) const;
+		uint32_t GetMisses (void) const;
+
+	private:
+		std::string GetFileName (const ResultKey& key) const;
+
+		std::string m_directory;
+		uint32_t m_hits;
+		uint32_t m_misses;
+};
+
+inline
+ResultCache::ResultCache (const std::string& directory)
+: m_directory (directory),
+m_hits (0),
+m_misses (0)
+{
+	if (mkdir (m_directory.c_str (), 0755) != 0 && errno != EEXIST)
+	{
+		NS_FATAL_ERROR ("Cannot create result cache directory " << m_directory);
+	}
+}
+
+inline std::string
+ResultCache::GetFileName (const ResultKey& key) const
+{
+	return m_directory + "/" + key.GetHash () + ".point";
+}
+
+inline bool
+ResultCache::Load (const ResultKey& key, SweepPointResult& result)
+{
+	std::ifstream file (GetFileName (key).c_str ());
+	std::string description;
+	if (file && std::getline (file, description) && description == key.GetDescription ())
+	{
+		std::ostringstream text;
+		text << file.rdbuf ();
+		if (DeserializeSweepPoint (text.str (), result))
+		{
+			m_hits++;
+			return true;
+		}
+	}
+	m_misses++;
+	return false;
+}
+
+inline void
+ResultCache::Store (const ResultKey& key, const SweepPointResult& result)
+{
+	if (!result.ok)
+	{
+		return;
+	}
+	//write a temporary file and rename it, so a concurrent run never reads half an entry
+	std::string fileName = GetFileName (key);
+	std::string tempName = fileName + "." + std::to_string (getpid ()) + ".tmp";
+	{
+		std::ofstream file (tempName.c_str ());
+		file << key.GetDescription () << "\n" << SerializeSweepPoint (result);
+		if (!file)
+		{
+			return;
+		}
+	}
+	std::rename (tempName.c_str (), fileName.c_str ());
+}
+
+inline uint32_t
+ResultCache::GetHits (void) const
+{
+	return m_hits;
+}
+
+inline uint32_t
+ResultCache::GetMisses (void) const
+{
+	return m_misses;
+}
+
+//key of the sweep point of a job
+typedef std::function<ResultKey (const SweepJob&)> ResultKeyFunction;
+
+//RunSweep that takes the points found in the cache from it and only simulates the others,
+//storing their results. With cacheOnly the missing points are not simulated and stay not ok,
+//which rebuilds the outputs of a previous sweep without running anything. Points taken from
+//the cache get the metric "cached" = 1: their run cost is the one of the run that stored them
+//and the files a simulation writes on the side were not written again.
+inline std::vector<SweepPointResult>
+RunCachedSweep (const std::vector<SweepJob>& jobs, uint32_t workers, const SweepFunction& simulate,
+                ResultCache& cache, const ResultKeyFunction& keyFunction, bool cacheOnly)
+{
+	std::vector<SweepPointResult> results (jobs.size ());
+	std::vector<SweepJob> missing;
+	std::vector<size_t> missingIndex;
+	for (size_t i = 0; i < jobs.size (); i++)
+	{
+		if (cache.Load (keyFunction (jobs[i]), results[i]))
+		{
+			results[i].metrics["cached"] = 1;
+		}
+		else
+		{
+			results[i] = SweepPointResult ();
+			results[i].packetSize = jobs[i].packetSize;
+			results[i].run = jobs[i].run;
+			missing.push_back (jobs[i]);
+			missingIndex.push_back (i);
+		}
+	}
+	if (cacheOnly || missing.empty ())
+	{
+		return results;
+	}
+	std::vector<SweepPointResult> simulated = RunSweep (missing, workers, simulate);
+	for (size_t i = 0; i < simulated.size (); i++)
+	{
+		cache.Store (keyFunction (missing[i]), simulated[i]);
+		results[missingIndex[i]] = simulated[i];
+	}
+	return results;
+}
+
+} // namespace ns3
+
+#endif /* RESULT_CACHE_H */
@@ -0,0 +1,269 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include "ns3/core-module.h"
+#include "ns3/gnuplot.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//a double as a JSON number, JSON has no nan and inf so non-finite values (e.g. the throughput of
+//a flow that received nothing) are written as null
+struct JsonNumber
+{
+	double value;
+};
+
+inline std::ostream&
+operator<< (std::ostream& os, JsonNumber v)
+{
+	if (!std::isfinite (v.value))
+	{
+		return os << "null";
+	}
+	return os << v.value;
+}
+
+//Collects the results of a sweep in memory and writes them in bulk, either as JSON Lines (one
+//file, every line a {"type":"meta"|"point"|"flow",...} record) or as CSV (one file per record
+//type: <prefix>.meta.csv, <prefix>.points.csv and <prefix>.flows.csv). Nothing is written
+//until Write() is called, so the simulation never waits on terminal or file I/O. The plots
+//are filled from the same point records with FillDataset().
+class ResultWriter
+{
+	public:
+		ResultWriter ();
+
+		//"csv" or "jsonl"
+		void SetFormat (const std::string& format);
+
+		//run metadata written once, e.g. the program, the options and the number of runs
+		void AddMetadata (const std::string& name, const std::string& value);
+
+		//add the sweep point and its flows, points that did not finish are skipped
+		void AddPoint (const SweepPointResult& result);
+		void AddPoints (const std::vector<SweepPointResult>& results);
+
+		const std::vector<SweepPointResult>& GetPoints (void) const;
+
+		//add (packet size, value) of every point to a dataset, value is "avgThroughput",
+		//"fairness" or the name of a metric
+		void FillDataset (Gnuplot2dDataset& dataset, const std::string& value) const;
+
+		//write all records to the file(s) named after prefix with one write per file
+		void Write (const std::string& prefix) const;
+
+	private:
+		static std::string Quote (const std::string& text);
+		static double GetValue (const SweepPointResult& result, const std::string& value);
+		std::string FormatJsonLines (void) const;
+		void WriteFile (const std::string& fileName, const std::string& data) const;
+
+		std::string m_format;
+		std::vector<std::pair<std::string, std::string> > m_metadata;
+		std::vector<SweepPointResult> m_points;
+};
+
+inline
+ResultWriter::ResultWriter ()
+: m_format ("csv")
+{
+}
+
+inline void
+ResultWriter::SetFormat (const std::string& format)
+{
+	if (format != "csv" && format != "jsonl")
+	{
+		NS_FATAL_ERROR ("Unknown result format " << format << ", use csv or jsonl");
+	}
+	m_format = format;
+}
+
+inline void
+ResultWriter::AddMetadata (const std::string& name, const std::string& value)
+{
+	m_metadata.push_back (std::make_pair (name, value));
+}
+
+inline void
+ResultWriter::AddPoint (const SweepPointResult& result)
+{
+	if (result.ok)
+	{
+		m_points.push_back (result);
+	}
+}
+
+inline void
+ResultWriter::AddPoints (const std::vector<SweepPointResult>& results)
+{
+	m_points.reserve (m_points.size () + results.size ());
+	for (const SweepPointResult& result : results)
+	{
+		AddPoint (result);
+	}
+}
+
+inline const std::vector<SweepPointResult>&
+ResultWriter::GetPoints (void) const
+{
+	return m_points;
+}
+
+inline double
+ResultWriter::GetValue (const SweepPointResult& result, const std::string& value)
+{
+	if (value == "avgThroughput")
+	{
+		return result.avgThroughput;
+	}
+	if (value == "fairness")
+	{
+		return result.fairness;
+	}
+	auto metric = result.metrics.find (value);
+	return metric != result.metrics.end () ? metric->second : 0.0;
+}
+
+inline void
+ResultWriter::FillDataset (Gnuplot2dDataset& dataset, const std::string& value) const
+{
+	for (const SweepPointResult& result : m_points)
+	{
+		dataset.Add (result.packetSize, GetValue (result, value));
+	}
+}
+
+inline std::string
+ResultWriter::Quote (const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			quoted += '\\';
+		}
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+inline std::string
+ResultWriter::FormatJsonLines (void) const
+{
+	std::ostringstream os;
+	os << std::setprecision (std::numeric_limits<double>::max_digits10);
+	os << "{\"type\":\"meta\"";
+	for (const auto& entry : m_metadata)
+	{
+		os << "," << Quote (entry.first) << ":" << Quote (entry.second);
+	}
+	os << "}\n";
+	for (const SweepPointResult& result : m_points)
+	{
+		os << "{\"type\":\"point\",\"packetSize\":" << result.packetSize << ",\"run\":" << result.run
+		   << ",\"avgThroughput\":" << JsonNumber {result.avgThroughput} << ",\"fairness\":" << JsonNumber {result.fairness}
+		   << ",\"flows\":" << result.flows.size ();
+		for (const auto& metric : result.metrics)
+		{
+			os << "," << Quote (metric.first) << ":" << JsonNumber {metric.second};
+		}
+		os << "}\n";
+		for (const FlowResult& flow : result.flows)
+		{
+			os << "{\"type\":\"flow\",\"packetSize\":" << result.packetSize << ",\"run\":" << result.run
+			   << ",\"flowId\":" << flow.flowId << ",\"rxBytes\":" << flow.rxBytes << ",\"firstTx\":" << JsonNumber {flow.firstTx}
+			   << ",\"lastRx\":" << JsonNumber {flow.lastRx} << ",\"throughput\":" << JsonNumber {flow.throughput} << "}\n";
+		}
+	}
+	return os.str ();
+}
+
+inline void
+ResultWriter::WriteFile (const std::string& fileName, const std::string& data) const
+{
+	std::ofstream file (fileName.c_str (), std::ios::binary);
+	if (!file)
+	{
+		NS_FATAL_ERROR ("Cannot write results to " << fileName);
+	}
+	file.write (data.data (), data.size ());
+}
+
+inline void
+ResultWriter::Write (const std::string& prefix) const
+{
+	if (m_format == "jsonl")
+	{
+		WriteFile (prefix + ".jsonl", FormatJsonLines ());
+		return;
+	}
+
+	std::ostringstream meta;
+	meta << "name,value\n";
+	for (const auto& entry : m_metadata)
+	{
+		meta << entry.first << "," << Quote (entry.second) << "\n";
+	}
+	WriteFile (prefix + ".meta.csv", meta.str ());
+
+	//the metric columns are the union of the metrics of all points, missing ones stay empty
+	std::map<std::string, bool> metricNames;
+	for (const SweepPointResult& result : m_points)
+	{
+		for (const auto& metric : result.metrics)
+		{
+			metricNames[metric.first] = true;
+		}
+	}
+	std::ostringstream points;
+	points << std::setprecision (std::numeric_limits<double>::max_digits10);
+	points << "packetSize,run,avgThroughput,fairness,flows";
+	for (const auto& name : metricNames)
+	{
+		points << "," << name.first;
+	}
+	points << "\n";
+	std::ostringstream flows;
+	flows << std::setprecision (std::numeric_limits<double>::max_digits10);
+	flows << "packetSize,run,flowId,rxBytes,firstTx,lastRx,throughput\n";
+	for (const SweepPointResult& result : m_points)
+	{
+		points << result.packetSize << "," << result.run << "," << result.avgThroughput << "," << result.fairness
+		       << "," << result.flows.size ();
+		for (const auto& name : metricNames)
+		{
+			points << ",";
+			auto metric = result.metrics.find (name.first);
+			if (metric != result.metrics.end ())
+			{
+				points << metric->second;
+			}
+		}
+		points << "\n";
+		for (const FlowResult& flow : result.flows)
+		{
+			flows << result.packetSize << "," << result.run << "," << flow.flowId << "," << flow.rxBytes << ","
+			      << flow.firstTx << "," << flow.lastRx << "," << flow.throughput << "\n";
+		}
+	}
+	WriteFile (prefix + ".points.csv", points.str ());
+	WriteFile (prefix + ".flows.csv", flows.str ());
+}
+
+} // namespace ns3
+
+#endif /* RESULT_WRITER_H */
@@ -0,0 +1,104 @@
+#ifndef ROUTING_MODE_H
+#define ROUTING_MODE_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nix-vector-routing-module.h"
+
+#include <string>
+
+namespace ns3
+{
+
+//How the routes of a scenario are set up:
+//global - Ipv4GlobalRoutingHelper::PopulateRoutingTables() runs an SPF over the whole graph
+//         and installs a full table on every node, setup grows superlinearly with the nodes
+//nix    - Nix-vector routing computes the path of a destination on demand when the first
+//         packet is sent to it and caches it, nothing is computed at setup
+//static - the scenario knows its shape (dumbbell, two BSS joined by a link) and gives every
+//         node a single static default route towards the other side
+enum RoutingMode
+{
+	ROUTING_GLOBAL,
+	ROUTING_NIX,
+	ROUTING_STATIC
+};
+
+//parse the --routing option, an empty name selects the default mode of the scenario
+inline RoutingMode
+ParseRoutingMode (const std::string& name, RoutingMode defaultMode)
+{
+	if (name.empty ())
+	{
+		return defaultMode;
+	}
+	if (name == "global")
+	{
+		return ROUTING_GLOBAL;
+	}
+	if (name == "nix")
+	{
+		return ROUTING_NIX;
+	}
+	if (name == "static")
+	{
+		return ROUTING_STATIC;
+	}
+	NS_FATAL_ERROR ("Unknown routing mode " << name << ", use global, nix or static");
+	return ROUTING_GLOBAL;
+}
+
+//name of a routing mode for printing
+inline std::string
+GetRoutingModeName (RoutingMode mode)
+{
+	switch (mode)
+	{
+		case ROUTING_NIX:
+			return "nix";
+		case ROUTING_STATIC:
+			return "static";
+		default:
+			return "global";
+	}
+}
+
+//select the routing protocol installed by the stack helper, call before Install()
+inline void
+SetStackRouting (InternetStackHelper& stack, RoutingMode mode)
+{
+	if (mode == ROUTING_NIX)
+	{
+		Ipv4NixVectorHelper nixRouting;
+		stack.SetRoutingHelper (nixRouting);
+	}
+}
+
+//route everything not directly connected over the interface of device to gateway,
+//only used by the static mode
+inline void
+AddDefaultRoute (RoutingMode mode, Ptr<NetDevice> device, Ipv4Address gateway)
+{
+	if (mode != ROUTING_STATIC)
+	{
+		return;
+	}
+	Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+	Ipv4StaticRoutingHelper routingHelper;
+	routingHelper.GetStaticRouting (ipv4)->SetDefaultRoute (gateway, ipv4->GetInterfaceForDevice (device));
+}
+
+//finish the routing setup once all addresses are assigned
+inline void
+PopulateRoutes (RoutingMode mode)
+{
+	if (mode == ROUTING_GLOBAL)
+	{
+		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+	}
+}
+
+} // namespace ns3
+
+#endif /* ROUTING_MODE_H */
@@ -0,0 +1,443 @@
+#ifndef SAMPLED_CAPTURE_H
+#define SAMPLED_CAPTURE_H
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+//Header only packet capture for long sweeps. A sample of the packets seen on the chosen devices
+//(one in N packets, or every packet of one in N flows by a hash of the addresses and ports of
+//both directions) has its first snapLength bytes copied into a ring of records preallocated up
+//front. Nothing is written while the simulation runs until a trigger fires:
+//- a drop burst: dropBurst drops within dropWindow on one of the drop traces added
+//- a cwnd collapse: the congestion window of a traced socket falling below collapseFraction of
+//  its previous value (e.g. a retransmission timeout)
+//- the end of the run, if the ring was not dumped since its last trigger
+//Then the ring is written oldest record first to <prefix>-<n>-<reason>.pcap and emptied.
+//Triggers seen while less than a quarter of the ring was refilled are counted but not dumped.
+//All devices of one capture share the link type of the first one installed: PPP for the
+//point-to-point devices, raw IPv4 for the ip interfaces (e.g. a wifi AP).
+class SampledCapture
+{
+	public:
+		enum SampleMode
+		{
+			SAMPLE_PACKETS,
+			SAMPLE_FLOWS
+		};
+
+		SampledCapture (const std::string& prefix, uint32_t records, uint32_t snapLength);
+
+		//keep one in oneIn packets (SAMPLE_PACKETS) or the packets of one in oneIn flows
+		void SetSampling (SampleMode mode, uint32_t oneIn);
+
+		//dump on drops drops within window, 0 drops disables the trigger
+		void SetDropBurstTrigger (uint32_t drops, Time window);
+
+		//dump when a cwnd falls below fraction of its previous value, 0 disables the trigger
+		void SetCwndCollapseTrigger (double fraction);
+
+		//files written at most, further triggers are only counted
+		void SetMaxDumps (uint32_t dumps);
+
+		//capture what a point-to-point device sends and receives, ppp header included
+		void InstallPointToPoint (Ptr<PointToPointNetDevice> device);
+
+		//capture the ipv4 packets sent and received over the interface of device on its node
+		void InstallIpv4Interface (Ptr<NetDevice> device);
+
+		//count the packets of a trace with the signature void (Ptr<const Packet>) as drops, e.g.
+		//"Drop" of a Queue<Packet> or "MacTxDrop" of a WifiMac
+		void AddDropTrace (Ptr<Object> object, const std::string& traceName);
+
+		//count the drops of the root queue disc of device (pfifo_fast once an ipv4 address is
+		//assigned) and of the device queue behind it; with flow control the tail drops happen in
+		//the queue disc and the "Drop" trace of the device queue alone rarely fires
+		void AddQueueDropTraces (Ptr<NetDevice> device);
+
+		//watch the congestion window of a socket, or of the socket an application creates when it
+		//starts (OnOffApplication, BulkSendApplication), for a collapse
+		void AddCwndTrace (Ptr<Socket> socket);
+		void AddApplicationCwndTrace (Ptr<Application> app, Time start);
+
+		//dump what was captured since the last dump, call after Simulator::Run()
+		void Finish (void);
+
+		//packets seen and sampled, files written and triggers not dumped
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+	private:
+		struct Record
+		{
+			int64_t timeNs;
+			uint32_t originalLength;
+			uint32_t capturedLength;
+		};
+
+		//pcap link types
+		static const uint32_t LINKTYPE_PPP = 9;
+		static const uint32_t LINKTYPE_RAW = 101;
+
+		static void NotifyDevice (SampledCapture* capture, Ptr<const Packet> packet);
+		static void NotifyIpv4 (SampledCapture* capture, uint32_t wanted, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+		static void NotifyDrop (SampledCapture* capture, Ptr<const Packet> packet);
+		static void NotifyQueueDiscDrop (SampledCapture* capture, Ptr<const QueueDiscItem> item);
+		static void NotifyCwnd (SampledCapture* capture, uint32_t oldValue, uint32_t newValue);
+
+		void SetLinkType (uint32_t linkType);
+		void Capture (Ptr<const Packet> packet);
+		bool IsSampledFlow (const uint8_t* data, uint32_t length) const;
+		void ConnectApplicationSocket (Ptr<Application> app);
+		void Trigger (const std::string& reason);
+		void Dump (const std::string& reason);
+
+		std::string m_prefix;
+		uint32_t m_snapLength;
+		std::vector<Record> m_records;
+		std::vector<uint8_t> m_data;
+		uint32_t m_next;        //slot written next
+		uint32_t m_used;        //records held, at most the ring size
+		uint32_t m_linkType;
+
+		SampleMode m_mode;
+		uint32_t m_oneIn;
+		uint32_t m_countdown;
+
+		uint32_t m_dropBurst;
+		Time m_dropWindow;
+		std::vector<Time> m_dropTimes;   //times of the last m_dropBurst drops, circular
+		uint32_t m_dropNext;
+		double m_collapseFraction;
+
+		uint32_t m_maxDumps;
+		uint32_t m_dumps;
+		uint32_t m_suppressed;
+		uint64_t m_seen;
+		uint64_t m_sampled;
+};
+
+inline
+SampledCapture::SampledCapture (const std::string& prefix, uint32_t records, uint32_t snapLength)
+: m_prefix (prefix),
+m_snapLength (std::max<uint32_t> (snapLength, 1)),
+m_records (std::max<uint32_t> (records, 1)),
+m_data (m_records.size () * m_snapLength),
+m_next (0),
+m_used (0),
+m_linkType (0),
+m_mode (SAMPLE_PACKETS),
+m_oneIn (1),
+m_countdown (1),
+m_dropBurst (0),
+m_dropWindow (MilliSeconds (100)),
+m_dropNext (0),
+m_collapseFraction (0),
+m_maxDumps (16),
+m_dumps (0),
+m_suppressed (0),
+m_seen (0),
+m_sampled (0)
+{
+}
+
+inline void
+SampledCapture::SetSampling (SampleMode mode, uint32_t oneIn)
+{
+	m_mode = mode;
+	m_oneIn = std::max<uint32_t> (oneIn, 1);
+	m_countdown = 1;
+}
+
+inline void
+SampledCapture::SetDropBurstTrigger (uint32_t drops, Time window)
+{
+	m_dropBurst = drops;
+	m_dropWindow = window;
+	m_dropTimes.assign (drops, Time (-1));
+	m_dropNext = 0;
+}
+
+inline void
+SampledCapture::SetCwndCollapseTrigger (double fraction)
+{
+	m_collapseFraction = fraction;
+}
+
+inline void
+SampledCapture::SetMaxDumps (uint32_t dumps)
+{
+	m_maxDumps = dumps;
+}
+
+inline void
+SampledCapture::SetLinkType (uint32_t linkType)
+{
+	NS_ABORT_MSG_IF (m_linkType != 0 && m_linkType != linkType, "A sampled capture holds the packets of one link type");
+	m_linkType = linkType;
+}
+
+inline void
+SampledCapture::InstallPointToPoint (Ptr<PointToPointNetDevice> device)
+{
+	SetLinkType (LINKTYPE_PPP);
+	device->TraceConnectWithoutContext ("PromiscSniffer", MakeBoundCallback (&SampledCapture::NotifyDevice, this));
+}
+
+inline void
+SampledCapture::InstallIpv4Interface (Ptr<NetDevice> device)
+{
+	SetLinkType (LINKTYPE_RAW);
+	Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+	int32_t interface = ipv4->GetInterfaceForDevice (device);
+	NS_ABORT_MSG_IF (interface < 0, "The captured device has no ipv4 interface");
+	ipv4->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&SampledCapture::NotifyIpv4, this, static_cast<uint32_t> (interface)));
+	ipv4->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&SampledCapture::NotifyIpv4, this, static_cast<uint32_t> (interface)));
+}
+
+inline void
+SampledCapture::AddDropTrace (Ptr<Object> object, const std::string& traceName)
+{
+	object->TraceConnectWithoutContext (traceName, MakeBoundCallback (&SampledCapture::NotifyDrop, this));
+}
+
+inline void
+SampledCapture::AddQueueDropTraces (Ptr<NetDevice> device)
+{
+	Ptr<TrafficControlLayer> tc = device->GetNode ()->GetObject<TrafficControlLayer> ();
+	if (tc != nullptr && tc->GetRootQueueDiscOnDevice (device) != nullptr)
+	{
+		//drops of the child queue discs (e.g. mq on a wifi device) are reported by the root
+		tc->GetRootQueueDiscOnDevice (device)->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&SampledCapture::NotifyQueueDiscDrop, this));
+	}
+	Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice> (device);
+	if (p2p != nullptr)
+	{
+		AddDropTrace (p2p->GetQueue (), "Drop");
+	}
+}
+
+inline void
+SampledCapture::AddCwndTrace (Ptr<Socket> socket)
+{
+	socket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&SampledCapture::NotifyCwnd, this));
+}
+
+inline void
+SampledCapture::AddApplicationCwndTrace (Ptr<Application> app, Time start)
+{
+	//the socket exists right after the start event of the application
+	Simulator::Schedule (start + NanoSeconds (1), &SampledCapture::ConnectApplicationSocket, this, app);
+}
+
+inline void
+SampledCapture::ConnectApplicationSocket (Ptr<Application> app)
+{
+	Ptr<Socket> socket;
+	Ptr<OnOffApplication> onOff = DynamicCast<OnOffApplication> (app);
+	Ptr<BulkSendApplication> bulkSend = DynamicCast<BulkSendApplication> (app);
+	if (onOff != nullptr)
+	{
+		socket = onOff->GetSocket ();
+	}
+	else if (bulkSend != nullptr)
+	{
+		socket = bulkSend->GetSocket ();
+	}
+	if (socket != nullptr)
+	{
+		AddCwndTrace (socket);
+	}
+}
+
+inline void
+SampledCapture::NotifyDevice (SampledCapture* capture, Ptr<const Packet> packet)
+{
+	capture->Capture (packet);
+}
+
+inline void
+SampledCapture::NotifyIpv4 (SampledCapture* capture, uint32_t wanted, Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+	if (interface == wanted)
+	{
+		capture->Capture (packet);
+	}
+}
+
+inline void
+SampledCapture::Capture (Ptr<const Packet> packet)
+{
+	m_seen++;
+	if (m_mode == SAMPLE_PACKETS && --m_countdown > 0)
+	{
+		return;
+	}
+	//copy straight into the next slot, a packet of a flow not sampled is overwritten by the next one
+	uint8_t* slot = &m_data[static_cast<size_t> (m_next) * m_snapLength];
+	uint32_t length = packet->CopyData (slot, m_snapLength);
+	if (m_mode == SAMPLE_FLOWS && !IsSampledFlow (slot, length))
+	{
+		return;
+	}
+	m_countdown = m_oneIn;
+	Record& record = m_records[m_next];
+	record.timeNs = Simulator::Now ().GetNanoSeconds ();
+	record.originalLength = packet->GetSize ();
+	record.capturedLength = length;
+	m_next = (m_next + 1) % m_records.size ();
+	m_used = std::min<uint32_t> (m_used + 1, m_records.size ());
+	m_sampled++;
+}
+
+inline bool
+SampledCapture::IsSampledFlow (const uint8_t* data, uint32_t length) const
+{
+	uint32_t ip = 0;
+	if (m_linkType == LINKTYPE_PPP)
+	{
+		//ppp protocol field of ipv4
+		if (length < 2 || data[0] != 0x00 || data[1] != 0x21)
+		{
+			return false;
+		}
+		ip = 2;
+	}
+	if (length < ip + 20 || (data[ip] >> 4) != 4)
+	{
+		return false;
+	}
+	uint32_t transport = ip + (data[ip] & 0x0f) * 4;
+	uint32_t source = (data[ip + 12] << 24) | (data[ip + 13] << 16) | (data[ip + 14] << 8) | data[ip + 15];
+	uint32_t destination = (data[ip + 16] << 24) | (data[ip + 17] << 16) | (data[ip + 18] << 8) | data[ip + 19];
+	uint32_t ports = 0;
+	if (length >= transport + 4)
+	{
+		ports = ((data[transport] << 8) | data[transport + 1]) ^ ((data[transport + 2] << 8) | data[transport + 3]);
+	}
+	//xor first so both directions of a flow hash alike
+	uint64_t hash = (static_cast<uint64_t> (source ^ destination) << 16 | ports) * 0x9e3779b97f4a7c15ULL;
+	return (hash >> 32) % m_oneIn == 0;
+}
+
+inline void
+SampledCapture::NotifyDrop (SampledCapture* capture, Ptr<const Packet> packet)
+{
+	if (capture->m_dropBurst == 0)
+	{
+		return;
+	}
+	//the slot about to be overwritten holds the drop m_dropBurst drops ago
+	Time now = Simulator::Now ();
+	Time& oldest = capture->m_dropTimes[capture->m_dropNext];
+	bool burst = !oldest.IsNegative () && now - oldest <= capture->m_dropWindow;
+	oldest = now;
+	capture->m_dropNext = (capture->m_dropNext + 1) % capture->m_dropBurst;
+	if (burst)
+	{
+		capture->Trigger ("drops");
+	}
+}
+
+inline void
+SampledCapture::NotifyQueueDiscDrop (SampledCapture* capture, Ptr<const QueueDiscItem> item)
+{
+	NotifyDrop (capture, item->GetPacket ());
+}
+
+inline void
+SampledCapture::NotifyCwnd (SampledCapture* capture, uint32_t oldValue, uint32_t newValue)
+{
+	if (capture->m_collapseFraction > 0 && newValue < capture->m_collapseFraction * oldValue)
+	{
+		capture->Trigger ("cwnd");
+	}
+}
+
+inline void
+SampledCapture::Trigger (const std::string& reason)
+{
+	if (m_used < m_records.size () / 4 || m_dumps >= m_maxDumps)
+	{
+		m_suppressed++;
+		return;
+	}
+	Dump (reason);
+}
+
+inline void
+SampledCapture::Finish (void)
+{
+	if (m_used > 0 && m_dumps < m_maxDumps)
+	{
+		Dump ("end");
+	}
+}
+
+inline void
+SampledCapture::Dump (const std::string& reason)
+{
+	std::string fileName = m_prefix + "-" + std::to_string (m_dumps) + "-" + reason + ".pcap";
+	std::FILE* file = std::fopen (fileName.c_str (), "wb");
+	if (file == nullptr)
+	{
+		NS_FATAL_ERROR ("Cannot open capture " << fileName);
+	}
+	//pcap global header: magic, version 2.4, utc offset, accuracy, snap length, link type
+	uint32_t header[6] = {0xa1b2c3d4, 0x00040002, 0, 0, m_snapLength, m_linkType != 0 ? m_linkType : LINKTYPE_RAW};
+	std::fwrite (header, sizeof (header), 1, file);
+	uint32_t first = (m_next + m_records.size () - m_used) % m_records.size ();
+	for (uint32_t i = 0; i < m_used; i++)
+	{
+		uint32_t slot = (first + i) % m_records.size ();
+		const Record& record = m_records[slot];
+		uint32_t recordHeader[4] = {static_cast<uint32_t> (record.timeNs / 1000000000),
+		                            static_cast<uint32_t> ((record.timeNs % 1000000000) / 1000),
+		                            record.capturedLength, record.originalLength};
+		std::fwrite (recordHeader, sizeof (recordHeader), 1, file);
+		std::fwrite (&m_data[static_cast<size_t> (slot) * m_snapLength], 1, record.capturedLength, file);
+	}
+	std::fclose (file);
+	m_used = 0;
+	m_dumps++;
+}
+
+inline void
+SampledCapture::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	metrics["captureSeen"] = m_seen;
+	metrics["captureSampled"] = m_sampled;
+	metrics["captureDumps"] = m_dumps;
+	metrics["captureSuppressed"] = m_suppressed;
+}
+
+//parse "packets" or "flows"
+inline SampledCapture::SampleMode
+ParseCaptureMode (const std::string& name)
+{
+	if (name == "packets")
+	{
+		return SampledCapture::SAMPLE_PACKETS;
+	}
+	if (name == "flows")
+	{
+		return SampledCapture::SAMPLE_FLOWS;
+	}
+	NS_FATAL_ERROR ("Unknown capture sampling " << name << ", use packets or flows");
+	return SampledCapture::SAMPLE_PACKETS;
+}
+
+} // namespace ns3
+
+#endif /* SAMPLED_CAPTURE_H */
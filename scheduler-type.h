@@ -0,0 +1,72 @@
+#ifndef SCHEDULER_TYPE_H
+#define SCHEDULER_TYPE_H
+
+#include "ns3/core-module.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+//Event schedulers of ns-3 selectable with the --scheduler option:
+//map      - std::map ordered by time, the ns-3 default
+//heap     - binary heap in a vector
+//calendar - calendar queue, buckets of a year of days, good for many near term events
+//list     - sorted linked list, cheap inserts close to the head only
+//priority - std::priority_queue
+inline std::vector<std::string>
+GetSchedulerNames (void)
+{
+	return {"map", "heap", "calendar", "list", "priority"};
+}
+
+//ns-3 type name of a scheduler, an empty name keeps the default scheduler and returns ""
+inline std::string
+GetSchedulerTypeName (const std::string& name)
+{
+	if (name.empty ())
+	{
+		return "";
+	}
+	if (name == "map")
+	{
+		return "ns3::MapScheduler";
+	}
+	if (name == "heap")
+	{
+		return "ns3::HeapScheduler";
+	}
+	if (name == "calendar")
+	{
+		return "ns3::CalendarScheduler";
+	}
+	if (name == "list")
+	{
+		return "ns3::ListScheduler";
+	}
+	if (name == "priority")
+	{
+		return "ns3::PriorityQueueScheduler";
+	}
+	NS_FATAL_ERROR ("Unknown scheduler " << name << ", use map, heap, calendar, list or priority");
+	return "";
+}
+
+//use the scheduler for the next simulation, call before any event is scheduled
+inline void
+SelectScheduler (const std::string& name)
+{
+	std::string typeName = GetSchedulerTypeName (name);
+	if (typeName.empty ())
+	{
+		return;
+	}
+	ObjectFactory factory;
+	factory.SetTypeId (typeName);
+	Simulator::SetScheduler (factory);
+}
+
+} // namespace ns3
+
+#endif /* SCHEDULER_TYPE_H */
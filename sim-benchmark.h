@@ -0,0 +1,340 @@
+#ifndef SIM_BENCHMARK_H
+#define SIM_BENCHMARK_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "sweep-runner.h"
+
+namespace ns3
+{
+
+//peak resident set size of this process in KB since it started or since the last
+//ResetPeakRss (), ru_maxrss where /proc is not available
+inline double
+GetPeakRssKb (void)
+{
+	std::ifstream status ("/proc/self/status");
+	std::string name;
+	while (status >> name)
+	{
+		if (name == "VmHWM:")
+		{
+			double kb = 0;
+			status >> kb;
+			return kb;
+		}
+		status.ignore (256, '\n');
+	}
+	struct rusage usage;
+	getrusage (RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+//reset the peak resident set size to the current one (linux 4.0 and later), returns false if
+//the peak can not be reset and still covers everything this process (and its parent before a
+//fork) did so far
+inline bool
+ResetPeakRss (void)
+{
+	std::ofstream clearRefs ("/proc/self/clear_refs");
+	return static_cast<bool> (clearRefs << "5" << std::flush);
+}
+
+//current resident set size of this process in KB
+inline double
+GetCurrentRssKb (void)
+{
+	std::ifstream statm ("/proc/self/statm");
+	double size = 0, resident = 0;
+	statm >> size >> resident;
+	return resident * sysconf (_SC_PAGESIZE) / 1024.0;
+}
+
+//number of packets created by this process so far, read from the uid a new packet gets from the
+//global packet uid counter (the probe packet itself included). It is a cumulative count: ns-3
+//keeps no count of the packets alive, so live packets are not measured.
+inline uint64_t
+GetCreatedPacketCount (void)
+{
+	return Create<Packet> ()->GetUid ();
+}
+
+//measures the cost of one Simulator::Run() call: wall clock time, number of executed
+//events, packets created during the run (not alive at its end), nodes and memory. Start() is called before the topology is built so that the memory
+//used by the topology and the statistics collectors is included.
+class RunProbe
+{
+	public:
+		RunProbe ();
+
+		//remember the memory in use before the sweep point is built
+		void Start (void);
+
+		//call just before and after Simulator::Run()
+		void BeginRun (void);
+		void EndRun (void);
+
+		//add the measurements to the metrics of a sweep point
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+	private:
+		std::chrono::steady_clock::time_point m_wallStart;
+		double m_wallSeconds;
+		uint64_t m_eventsStart;
+		uint64_t m_events;
+		uint64_t m_packetsStart;
+		uint64_t m_packets;
+		uint32_t m_nodes;
+		double m_rssStartKb;
+		double m_rssEndKb;
+		double m_peakRssKb;
+		bool m_peakReset;       //m_peakRssKb only covers this sweep point
+		double m_simSeconds;
+};
+
+inline
+RunProbe::RunProbe ()
+: m_wallSeconds (0),
+m_eventsStart (0),
+m_events (0),
+m_packetsStart (0),
+m_packets (0),
+m_nodes (0),
+m_rssStartKb (0),
+m_rssEndKb (0),
+m_peakRssKb (0),
+m_peakReset (false),
+m_simSeconds (0)
+{
+}
+
+inline void
+RunProbe::Start (void)
+{
+	m_peakReset = ResetPeakRss ();
+	m_rssStartKb = GetCurrentRssKb ();
+}
+
+inline void
+RunProbe::BeginRun (void)
+{
+	m_eventsStart = Simulator::GetEventCount ();
+	m_packetsStart = GetCreatedPacketCount ();
+	m_wallStart = std::chrono::steady_clock::now ();
+}
+
+inline void
+RunProbe::EndRun (void)
+{
+	m_wallSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_wallStart).count ();
+	m_events = Simulator::GetEventCount () - m_eventsStart;
+	//minus the probe packet created by BeginRun ()
+	m_packets = GetCreatedPacketCount () - m_packetsStart - 1;
+	m_nodes = NodeList::GetNNodes ();
+	m_simSeconds = Simulator::Now ().GetSeconds ();
+	m_rssEndKb = GetCurrentRssKb ();
+	m_peakRssKb = GetPeakRssKb ();
+}
+
+inline void
+RunProbe::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	metrics["wallSeconds"] = m_wallSeconds;
+	metrics["events"] = m_events;
+	metrics["eventsPerSecond"] = m_wallSeconds > 0 ? m_events / m_wallSeconds : 0.0;
+	metrics["simSeconds"] = m_simSeconds;
+	metrics["simSecondsPerWallSecond"] = m_wallSeconds > 0 ? m_simSeconds / m_wallSeconds : 0.0;
+	metrics["packetsCreated"] = m_packets;
+	metrics["nodes"] = m_nodes;
+	metrics["rssGrowthKb"] = m_rssEndKb - m_rssStartKb;
+	//a peak that could not be reset depends on the points run before in the same process, it
+	//is left out so that it is not compared against a baseline
+	if (m_peakReset)
+	{
+		metrics["peakRssKb"] = m_peakRssKb;
+	}
+}
+
+//whether a sweep point was taken from the result cache instead of being simulated, its run cost
+//metrics are then not those of this run
+inline bool
+IsCachedPoint (const SweepPointResult& result)
+{
+	std::map<std::string, double>::const_iterator cached = result.metrics.find ("cached");
+	return cached != result.metrics.end () && cached->second > 0;
+}
+
+//print the run cost of the same sweep simulated with different configurations side by side
+inline void
+PrintRunComparison (std::ostream& os, const std::vector<std::string>& names,
+                    const std::vector<std::vector<SweepPointResult> >& sweeps)
+{
+	os << "Packet-Size\tMode\t\tEvents\t\tWall(s)\tEvents/s\tRSS growth(KB)\tPeak RSS(KB)" << std::endl;
+	for (size_t i = 0; !sweeps.empty () && i < sweeps[0].size (); i++)
+	{
+		for (size_t m = 0; m < sweeps.size (); m++)
+		{
+			const SweepPointResult& result = sweeps[m][i];
+			if (!result.ok)
+			{
+				continue;
+			}
+			std::map<std::string, double> metrics = result.metrics;
+			os << result.packetSize << "\t\t" << names[m] << "\t\t" << metrics["events"] << "\t"
+			   << metrics["wallSeconds"] << "\t" << metrics["eventsPerSecond"] << "\t"
+			   << metrics["rssGrowthKb"] << "\t\t" << metrics["peakRssKb"] << std::endl;
+		}
+	}
+}
+
+//Write the run cost of a sweep as a benchmark report, one json object per line and sweep point:
+//{"mode":"...","packetSize":40,"run":1,"wallSeconds":...,...} with every metric of the point.
+//Points taken from the result cache are left out.
+inline void
+WriteBenchmarkReport (const std::string& fileName, const std::string& mode,
+                      const std::vector<SweepPointResult>& results)
+{
+	std::ofstream report (fileName.c_str ());
+	if (!report)
+	{
+		NS_FATAL_ERROR ("Cannot write benchmark report " << fileName);
+	}
+	report.precision (12);
+	for (const SweepPointResult& result : results)
+	{
+		if (!result.ok || IsCachedPoint (result))
+		{
+			continue;
+		}
+		report << "{\"mode\":\"" << mode << "\",\"packetSize\":" << result.packetSize << ",\"run\":" << result.run;
+		for (const auto& metric : result.metrics)
+		{
+			report << ",\"" << metric.first << "\":" << (std::isfinite (metric.second) ? metric.second : 0.0);
+		}
+		report << "}" << std::endl;
+	}
+}
+
+//metrics of every sweep point of a report written by WriteBenchmarkReport, keyed by mode,
+//packet size and run
+typedef std::map<std::string, std::map<std::string, double> > BenchmarkReport;
+
+inline std::string
+GetBenchmarkKey (const std::string& mode, uint32_t packetSize, uint32_t run)
+{
+	return mode + "/" + std::to_string (packetSize) + "/" + std::to_string (run);
+}
+
+inline BenchmarkReport
+ReadBenchmarkReport (const std::string& fileName)
+{
+	BenchmarkReport report;
+	std::ifstream file (fileName.c_str ());
+	if (!file)
+	{
+		NS_FATAL_ERROR ("Cannot open benchmark baseline " << fileName);
+	}
+	std::string line;
+	while (std::getline (file, line))
+	{
+		//only the flat objects written above are understood: "name":value pairs
+		std::map<std::string, double> metrics;
+		std::string mode;
+		size_t pos = 0;
+		while ((pos = line.find ('"', pos)) != std::string::npos)
+		{
+			size_t end = line.find ('"', pos + 1);
+			if (end == std::string::npos || end + 1 >= line.size () || line[end + 1] != ':')
+			{
+				break;
+			}
+			std::string name = line.substr (pos + 1, end - pos - 1);
+			size_t value = end + 2;
+			if (line[value] == '"')
+			{
+				size_t valueEnd = line.find ('"', value + 1);
+				mode = line.substr (value + 1, valueEnd - value - 1);
+				pos = valueEnd + 1;
+			}
+			else
+			{
+				metrics[name] = std::strtod (line.c_str () + value, nullptr);
+				pos = line.find_first_of (",}", value);
+			}
+		}
+		if (metrics.count ("packetSize") > 0)
+		{
+			report[GetBenchmarkKey (mode, metrics["packetSize"], metrics["run"])] = metrics;
+		}
+	}
+	return report;
+}
+
+//Compare the run cost of a sweep with a baseline report. A sweep point regresses when its wall
+//time or peak RSS grew, or its events/sec dropped, by more than threshold (0.1 = 10%) relative
+//to the baseline. Prints one line per sweep point and returns the number of regressions. Points
+//taken from the result cache are not compared.
+inline uint32_t
+CompareWithBaseline (std::ostream& os, const BenchmarkReport& baseline, const std::string& mode,
+                     const std::vector<SweepPointResult>& results, double threshold)
+{
+	//metric name and whether a larger value is worse
+	const std::vector<std::pair<std::string, bool> > checked = {
+		{"wallSeconds", true}, {"eventsPerSecond", false}, {"peakRssKb", true}};
+	uint32_t regressions = 0;
+	os << "Packet-Size\tRun\tMetric\t\tBaseline\tCurrent\t\tChange" << std::endl;
+	for (const SweepPointResult& result : results)
+	{
+		if (!result.ok)
+		{
+			continue;
+		}
+		if (IsCachedPoint (result))
+		{
+			os << result.packetSize << "\t\t" << result.run << "\tcached, not compared" << std::endl;
+			continue;
+		}
+		auto base = baseline.find (GetBenchmarkKey (mode, result.packetSize, result.run));
+		if (base == baseline.end ())
+		{
+			os << result.packetSize << "\t\t" << result.run << "\tnot in baseline" << std::endl;
+			continue;
+		}
+		for (const auto& metric : checked)
+		{
+			auto baseValue = base->second.find (metric.first);
+			auto value = result.metrics.find (metric.first);
+			if (baseValue == base->second.end () || value == result.metrics.end () || baseValue->second <= 0)
+			{
+				continue;
+			}
+			double change = (value->second - baseValue->second) / baseValue->second;
+			bool regressed = metric.second ? change > threshold : -change > threshold;
+			os << result.packetSize << "\t\t" << result.run << "\t" << metric.first << "\t" << baseValue->second
+			   << "\t" << value->second << "\t" << change * 100 << "%" << (regressed ? "\tREGRESSION" : "") << std::endl;
+			if (regressed)
+			{
+				regressions++;
+			}
+		}
+	}
+	os << regressions << " regression(s) above " << threshold * 100 << "%" << std::endl;
+	return regressions;
+}
+
+} // namespace ns3
+
+#endif /* SIM_BENCHMARK_H */
@@ -0,0 +1,232 @@
+#ifndef STEADY_STATE_MONITOR_H
+#define STEADY_STATE_MONITOR_H
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "flow-accounting.h"
+
+namespace ns3
+{
+
+//Watches the throughput of every flow over sliding windows and stops the simulation once
+//it has converged. Windows before the warm-up time (and before any data arrived) are
+//discarded so slow start is not part of the decision. The last historyLength windows of
+//every flow are kept in a ring; a flow is stable when the mean and the standard deviation
+//of the older and the newer half of its history differ by less than tolerance times the mean.
+class SteadyStateMonitor
+{
+	public:
+		//why the simulation of a sweep point ended
+		enum StopReason
+		{
+			TIME_LIMIT = 0,    //the fixed stop time was reached
+			STEADY_STATE = 1,  //all flows converged
+			IDLE = 2           //all flows stopped receiving data
+		};
+
+		SteadyStateMonitor (const FlowAccounting& accounting, Time window, uint32_t historyLength,
+		                    double tolerance, Time warmup);
+
+		//schedule the first window, call before Simulator::Run()
+		void Start (void);
+
+		//reason and time of the end of the simulation, call after Simulator::Run()
+		StopReason GetStopReason (void) const;
+		Time GetStopTime (void) const;
+
+		//mean throughput of a flow over the windows in the history (Kbps)
+		double GetSteadyThroughput (uint32_t flow) const;
+
+		//add stop time, stop reason and the steady state average throughput and fairness to the metrics
+		void AddMetrics (std::map<std::string, double>& metrics) const;
+
+		//name of a stop reason for printing
+		static std::string GetStopReasonName (double reason);
+
+	private:
+		//measure one window and stop the simulation if all flows are stable
+		void Sample (void);
+
+		//mean and standard deviation of the history of a flow between two ring offsets
+		void HalfStatistics (uint32_t flow, uint32_t from, uint32_t to, double& mean, double& stddev) const;
+		bool IsStable (uint32_t flow) const;
+
+		const FlowAccounting& m_accounting;
+		Time m_window;
+		uint32_t m_historyLength;
+		double m_tolerance;
+		Time m_warmup;
+		std::vector<uint64_t> m_lastRxBytes;
+		std::vector<double> m_history;   //historyLength windows per flow, flow major
+		uint32_t m_next;                 //ring position written next
+		uint32_t m_count;                //number of windows stored
+		StopReason m_reason;
+		Time m_stopTime;
+};
+
+inline
+SteadyStateMonitor::SteadyStateMonitor (const FlowAccounting& accounting, Time window, uint32_t historyLength,
+                                        double tolerance, Time warmup)
+: m_accounting (accounting),
+m_window (window),
+m_historyLength (historyLength < 4 ? 4 : historyLength),
+m_tolerance (tolerance),
+m_warmup (warmup),
+m_next (0),
+m_count (0),
+m_reason (TIME_LIMIT),
+m_stopTime (Seconds (0))
+{
+}
+
+inline void
+SteadyStateMonitor::Start (void)
+{
+	uint32_t nFlows = m_accounting.GetFlows ().size ();
+	m_lastRxBytes.assign (nFlows, 0);
+	m_history.assign (nFlows * m_historyLength, 0.0);
+	Simulator::Schedule (m_window, &SteadyStateMonitor::Sample, this);
+}
+
+inline void
+SteadyStateMonitor::Sample (void)
+{
+	//flows that appear after Start() are not monitored
+	const std::vector<FlowAccounting::FlowCounters>& flows = m_accounting.GetFlows ();
+	uint32_t nFlows = std::min<size_t> (flows.size (), m_lastRxBytes.size ());
+	bool receiving = false;
+	for (uint32_t i = 0; i < nFlows; i++)
+	{
+		double throughput = (flows[i].rxBytes - m_lastRxBytes[i]) * 8.0 / m_window.GetSeconds () / 1024;
+		m_history[i * m_historyLength + m_next] = throughput;
+		m_lastRxBytes[i] = flows[i].rxBytes;
+		receiving = receiving || flows[i].rxBytes > 0;
+	}
+
+	//discard the warm-up phase: keep overwriting the same slot until it is over
+	if (Simulator::Now () < m_warmup || !receiving)
+	{
+		Simulator::Schedule (m_window, &SteadyStateMonitor::Sample, this);
+		return;
+	}
+	m_next = (m_next + 1) % m_historyLength;
+	if (m_count < m_historyLength)
+	{
+		m_count++;
+	}
+
+	if (m_count == m_historyLength)
+	{
+		bool stable = true;
+		double total = 0.0;
+		for (uint32_t i = 0; i < nFlows && stable; i++)
+		{
+			stable = IsStable (i);
+			total += GetSteadyThroughput (i);
+		}
+		if (stable)
+		{
+			m_reason = total > 0 ? STEADY_STATE : IDLE;
+			m_stopTime = Simulator::Now ();
+			Simulator::Stop ();
+			return;
+		}
+	}
+	Simulator::Schedule (m_window, &SteadyStateMonitor::Sample, this);
+}
+
+inline void
+SteadyStateMonitor::HalfStatistics (uint32_t flow, uint32_t from, uint32_t to, double& mean, double& stddev) const
+{
+	//offsets are relative to the oldest window in the ring
+	const double* history = &m_history[flow * m_historyLength];
+	double sum = 0.0, squareSum = 0.0;
+	for (uint32_t k = from; k < to; k++)
+	{
+		double x = history[(m_next + k) % m_historyLength];
+		sum += x;
+		squareSum += x * x;
+	}
+	uint32_t n = to - from;
+	mean = sum / n;
+	stddev = std::sqrt (std::max (0.0, squareSum / n - mean * mean));
+}
+
+inline bool
+SteadyStateMonitor::IsStable (uint32_t flow) const
+{
+	double mean1, stddev1, mean2, stddev2;
+	HalfStatistics (flow, 0, m_historyLength / 2, mean1, stddev1);
+	HalfStatistics (flow, m_historyLength / 2, m_historyLength, mean2, stddev2);
+	double scale = std::max (mean1, mean2);
+	if (scale <= 0)
+	{
+		return true;
+	}
+	return std::fabs (mean1 - mean2) <= m_tolerance * scale && std::fabs (stddev1 - stddev2) <= m_tolerance * scale;
+}
+
+inline SteadyStateMonitor::StopReason
+SteadyStateMonitor::GetStopReason (void) const
+{
+	return m_reason;
+}
+
+inline Time
+SteadyStateMonitor::GetStopTime (void) const
+{
+	return m_reason == TIME_LIMIT ? Simulator::Now () : m_stopTime;
+}
+
+inline double
+SteadyStateMonitor::GetSteadyThroughput (uint32_t flow) const
+{
+	if (m_count == 0)
+	{
+		return 0.0;
+	}
+	double mean, stddev;
+	HalfStatistics (flow, m_historyLength - m_count, m_historyLength, mean, stddev);
+	return mean;
+}
+
+inline void
+SteadyStateMonitor::AddMetrics (std::map<std::string, double>& metrics) const
+{
+	double sum = 0.0, squareSum = 0.0;
+	uint32_t nFlows = m_lastRxBytes.size ();
+	for (uint32_t i = 0; i < nFlows; i++)
+	{
+		double throughput = GetSteadyThroughput (i);
+		sum += throughput;
+		squareSum += throughput * throughput;
+	}
+	metrics["stopTime"] = GetStopTime ().GetSeconds ();
+	metrics["stopReason"] = m_reason;
+	metrics["steadyAvgThroughput"] = nFlows > 0 ? sum / nFlows : 0.0;
+	metrics["steadyFairness"] = squareSum > 0 ? (sum * sum) / (nFlows * squareSum) : 0.0;
+}
+
+inline std::string
+SteadyStateMonitor::GetStopReasonName (double reason)
+{
+	switch (static_cast<int> (reason))
+	{
+		case STEADY_STATE:
+			return "steady state";
+		case IDLE:
+			return "flows idle";
+		default:
+			return "time limit";
+	}
+}
+
+} // namespace ns3
+
+#endif /* STEADY_STATE_MONITOR_H */
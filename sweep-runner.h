@@ -0,0 +1,358 @@
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+//statistics of a single flow observed during one sweep point
+struct FlowResult
+{
+	uint32_t flowId;
+	uint64_t rxBytes;
+	double firstTx;     //time when first packet was transmitted (s)
+	double lastRx;      //time when last packet was received (s)
+	double throughput;  //throughput in Kbps
+	std::string type;   //congestion control of the sender, empty if not known
+};
+
+//one simulation to run: a packet size and the rng run number used for it
+struct SweepJob
+{
+	uint32_t packetSize;
+	uint32_t run;
+};
+
+//statistics of one simulated sweep point (one packet size and rng run)
+struct SweepPointResult
+{
+	uint32_t packetSize;
+	uint32_t run;
+	bool ok;
+	double avgThroughput;
+	double fairness;
+	std::vector<FlowResult> flows;
+	std::map<std::string, double> metrics;  //named measurements of the run (e.g. benchmark counters)
+
+	SweepPointResult ()
+	: packetSize (0),
+	run (1),
+	ok (false),
+	avgThroughput (0.0),
+	fairness (0.0)
+	{
+	}
+};
+
+//function simulating the topology for one sweep job
+typedef std::function<SweepPointResult (const SweepJob&)> SweepFunction;
+
+//create the jobs for every packet size, replicated "runs" times with rng runs 1..runs
+inline std::vector<SweepJob>
+MakeSweepJobs (const std::vector<uint32_t>& packetSizes, uint32_t runs)
+{
+	std::vector<SweepJob> jobs;
+	for (uint32_t ps : packetSizes)
+	{
+		for (uint32_t run = 1; run <= runs; run++)
+		{
+			jobs.push_back ({ps, run});
+		}
+	}
+	return jobs;
+}
+
+//a double as text that ReadSweepValue reads back, non-finite values (e.g. the throughput of a
+//flow whose first and last packet came at the same time) as nan, inf and -inf
+struct SweepValue
+{
+	double value;
+};
+
+inline std::ostream&
+operator<< (std::ostream& os, SweepValue v)
+{
+	if (std::isnan (v.value))
+	{
+		return os << "nan";
+	}
+	if (std::isinf (v.value))
+	{
+		return os << (v.value > 0 ? "inf" : "-inf");
+	}
+	return os << v.value;
+}
+
+//read a double written with SweepValue, operator>> does not parse nan and inf
+inline bool
+ReadSweepValue (std::istream& is, double& value)
+{
+	std::string token;
+	if (!(is >> token))
+	{
+		return false;
+	}
+	char* end = nullptr;
+	value = std::strtod (token.c_str (), &end);
+	return end != token.c_str () && *end == '\0';
+}
+
+//convert a sweep point result to text so that it can be sent from a worker process to the parent
+inline std::string
+SerializeSweepPoint (const SweepPointResult& result)
+{
+	std::ostringstream os;
+	os << std::setprecision (std::numeric_limits<double>::max_digits10);
+	os << "point " << result.packetSize << " " << result.run << " " << SweepValue {result.avgThroughput} << " "
+	   << SweepValue {result.fairness} << " " << result.flows.size () << "\n";
+	for (const FlowResult& flow : result.flows)
+	{
+		os << "flow " << flow.flowId << " " << flow.rxBytes << " " << SweepValue {flow.firstTx} << " "
+		   << SweepValue {flow.lastRx} << " " << SweepValue {flow.throughput} << " " << (flow.type.empty () ? "-" : flow.type) << "\n";
+	}
+	for (const auto& metric : result.metrics)
+	{
+		os << "metric " << metric.first << " " << SweepValue {metric.second} << "\n";
+	}
+	return os.str ();
+}
+
+//parse the text written by SerializeSweepPoint, returns false if the text is malformed
+inline bool
+DeserializeSweepPoint (const std::string& text, SweepPointResult& result)
+{
+	std::istringstream is (text);
+	std::string tag;
+	size_t nFlows = 0;
+	if (!(is >> tag >> result.packetSize >> result.run) || tag != "point" || !ReadSweepValue (is, result.avgThroughput)
+	    || !ReadSweepValue (is, result.fairness) || !(is >> nFlows))
+	{
+		return false;
+	}
+	result.flows.resize (nFlows);
+	for (FlowResult& flow : result.flows)
+	{
+		if (!(is >> tag >> flow.flowId >> flow.rxBytes) || tag != "flow" || !ReadSweepValue (is, flow.firstTx)
+		    || !ReadSweepValue (is, flow.lastRx) || !ReadSweepValue (is, flow.throughput) || !(is >> flow.type))
+		{
+			return false;
+		}
+		if (flow.type == "-")
+		{
+			flow.type.clear ();
+		}
+	}
+	std::string name;
+	double value;
+	while (is >> tag)
+	{
+		if (tag != "metric" || !(is >> name) || !ReadSweepValue (is, value))
+		{
+			return false;
+		}
+		result.metrics[name] = value;
+	}
+	result.ok = true;
+	return true;
+}
+
+//number of workers used when no pool size is given: one per online cpu core
+inline uint32_t
+DefaultSweepWorkers (void)
+{
+	long n = sysconf (_SC_NPROCESSORS_ONLN);
+	return n > 0 ? static_cast<uint32_t> (n) : 1;
+}
+
+//write the whole buffer to a file descriptor, retrying on short writes
+inline bool
+WriteAll (int fd, const std::string& data)
+{
+	size_t done = 0;
+	while (done < data.size ())
+	{
+		ssize_t n = write (fd, data.data () + done, data.size () - done);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n <= 0)
+		{
+			return false;
+		}
+		done += n;
+	}
+	return true;
+}
+
+//simulate every job, forking one worker process per sweep point with at most
+//"workers" processes alive at a time. Every worker owns its own copy of the simulator
+//singleton and sends its statistics back to the parent over a pipe. Results are returned
+//in the order of the jobs. With a pool size of 1 the points run inline one after another.
+inline std::vector<SweepPointResult>
+RunSweep (const std::vector<SweepJob>& jobs, uint32_t workers, const SweepFunction& simulate)
+{
+	std::vector<SweepPointResult> results (jobs.size ());
+	if (workers == 0)
+	{
+		workers = DefaultSweepWorkers ();
+	}
+	if (workers <= 1)
+	{
+		for (size_t i = 0; i < jobs.size (); i++)
+		{
+			results[i] = simulate (jobs[i]);
+		}
+		return results;
+	}
+
+	//bookkeeping for a forked worker process
+	struct Worker
+	{
+		pid_t pid;
+		int fd;
+		size_t index;
+		std::string data;
+	};
+	std::vector<Worker> running;
+	size_t next = 0;
+
+	while (next < jobs.size () || !running.empty ())
+	{
+		//start new workers until the pool is full
+		while (next < jobs.size () && running.size () < workers)
+		{
+			//flush buffered output so that it is not written twice by the child
+			std::cout.flush ();
+			std::clog.flush ();
+			fflush (stdout);
+
+			int fds[2];
+			pid_t pid = -1;
+			if (pipe (fds) == 0)
+			{
+				pid = fork ();
+				if (pid == 0)
+				{
+					close (fds[0]);
+					bool written = WriteAll (fds[1], SerializeSweepPoint (simulate (jobs[next])));
+					close (fds[1]);
+					std::cout.flush ();
+					std::clog.flush ();
+					_exit (written ? 0 : 1);
+				}
+				close (fds[1]);
+				if (pid < 0)
+				{
+					close (fds[0]);
+				}
+			}
+			if (pid < 0)
+			{
+				//could not start a worker, simulate this point in the parent instead
+				perror ("sweep worker");
+				results[next] = simulate (jobs[next]);
+				next++;
+				continue;
+			}
+			running.push_back ({pid, fds[0], next, std::string ()});
+			next++;
+		}
+		if (running.empty ())
+		{
+			continue;
+		}
+
+		//wait until one of the workers has written data or finished
+		std::vector<struct pollfd> pfds;
+		for (const Worker& w : running)
+		{
+			pfds.push_back ({w.fd, POLLIN, 0});
+		}
+		if (poll (pfds.data (), pfds.size (), -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			//the workers can not be waited for any more: stop them and fail their points and the
+			//points not started yet
+			perror ("poll");
+			for (const Worker& w : running)
+			{
+				kill (w.pid, SIGKILL);
+				close (w.fd);
+				waitpid (w.pid, nullptr, 0);
+			}
+			for (size_t i = 0; i < jobs.size (); i++)
+			{
+				if (!results[i].ok)
+				{
+					results[i].packetSize = jobs[i].packetSize;
+					results[i].run = jobs[i].run;
+				}
+			}
+			return results;
+		}
+
+		//iterate backwards so that finished workers can be erased while iterating
+		for (size_t k = running.size (); k-- > 0;)
+		{
+			if (!(pfds[k].revents & (POLLIN | POLLHUP | POLLERR)))
+			{
+				continue;
+			}
+			Worker& w = running[k];
+			char buf[4096];
+			ssize_t n = read (w.fd, buf, sizeof (buf));
+			if (n > 0)
+			{
+				w.data.append (buf, n);
+				continue;
+			}
+			if (n < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			//end of stream, the worker is done
+			close (w.fd);
+			int status = 0;
+			waitpid (w.pid, &status, 0);
+			SweepPointResult& result = results[w.index];
+			if (!WIFEXITED (status) || WEXITSTATUS (status) != 0 || !DeserializeSweepPoint (w.data, result))
+			{
+				std::cerr << "Sweep worker for packet size " << jobs[w.index].packetSize << " run "
+				          << jobs[w.index].run << " failed" << std::endl;
+				result = SweepPointResult ();
+			}
+			result.packetSize = jobs[w.index].packetSize;
+			result.run = jobs[w.index].run;
+			running.erase (running.begin () + k);
+		}
+	}
+	return results;
+}
+
+} // namespace ns3
+
+#endif /* SWEEP_RUNNER_H */
@@ -0,0 +1,323 @@
+#ifndef TCP_STATE_TRACER_H
+#define TCP_STATE_TRACER_H
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+//one traced change of a tcp socket, 16 bytes in memory and in the binary file
+struct TcpStateSample
+{
+	int64_t timeNs;
+	uint32_t value;   //bytes for cwnd and ssthresh, microseconds for the rtt, the state for CongState
+	uint8_t kind;     //one of the TcpStateTracer::Kind values
+	uint8_t padding[3];
+};
+
+//Records the CongestionWindow, RTT, SlowStartThreshold and CongState traces of tcp sockets.
+//Every flow owns a ring buffer preallocated when the socket is added; a trace only stores a
+//sample in it, and a full buffer is appended to the file in one write before it wraps, so the
+//hot path never allocates. The file is:
+//  "TCPSTATE" magic, uint32 version
+//  name records:   uint8 'N', uint32 flow, uint32 length, length chars
+//  sample records: uint8 'S', uint32 flow, uint32 count, count TcpStateSample
+//in host byte order. ConvertTcpStateTrace() turns it into a csv file.
+class TcpStateTracer
+{
+	public:
+		enum Kind
+		{
+			CWND = 0,
+			RTT = 1,
+			SSTHRESH = 2,
+			CONG_STATE = 3
+		};
+
+		//samples buffered per flow before they are written out
+		TcpStateTracer (const std::string& fileName, uint32_t samplesPerFlow);
+		~TcpStateTracer ();
+
+		//trace a socket that already exists, name identifies the flow in the csv
+		void AddSocket (Ptr<Socket> socket, const std::string& name);
+
+		//trace the socket of an application that creates it when it starts (e.g. OnOffApplication),
+		//call before the simulation starts with the start time of the application
+		void AddApplicationSocket (Ptr<Application> app, Time start, const std::string& name);
+
+		//write out what is left in the buffers and close the file, call after Simulator::Run()
+		void Finish (void);
+
+		uint64_t GetSampleCount (void) const;
+
+		static const char* GetKindName (uint8_t kind);
+
+	private:
+		struct Flow
+		{
+			std::vector<TcpStateSample> samples;
+			uint32_t used;
+		};
+
+		static void CwndChanged (TcpStateTracer* tracer, uint32_t flow, uint32_t oldValue, uint32_t newValue);
+		static void SsthreshChanged (TcpStateTracer* tracer, uint32_t flow, uint32_t oldValue, uint32_t newValue);
+		static void RttChanged (TcpStateTracer* tracer, uint32_t flow, Time oldValue, Time newValue);
+		static void CongStateChanged (TcpStateTracer* tracer, uint32_t flow, TcpSocketState::TcpCongState_t oldValue, TcpSocketState::TcpCongState_t newValue);
+
+		void ConnectApplicationSocket (Ptr<Application> app, uint32_t flow);
+		void Connect (Ptr<Socket> socket, uint32_t flow);
+		uint32_t AddFlow (const std::string& name);
+		void Record (uint32_t flow, uint8_t kind, uint32_t value);
+		void WriteFlow (uint32_t flow);
+
+		std::FILE* m_file;
+		uint32_t m_samplesPerFlow;
+		std::vector<Flow> m_flows;
+		uint64_t m_samples;
+};
+
+inline
+TcpStateTracer::TcpStateTracer (const std::string& fileName, uint32_t samplesPerFlow)
+: m_file (std::fopen (fileName.c_str (), "wb")),
+m_samplesPerFlow (samplesPerFlow < 1 ? 1 : samplesPerFlow),
+m_samples (0)
+{
+	if (m_file == nullptr)
+	{
+		NS_FATAL_ERROR ("Cannot open tcp state trace " << fileName);
+	}
+	uint32_t version = 1;
+	std::fwrite ("TCPSTATE", 1, 8, m_file);
+	std::fwrite (&version, sizeof (version), 1, m_file);
+}
+
+inline
+TcpStateTracer::~TcpStateTracer ()
+{
+	Finish ();
+}
+
+inline uint32_t
+TcpStateTracer::AddFlow (const std::string& name)
+{
+	uint32_t flow = m_flows.size ();
+	m_flows.emplace_back ();
+	m_flows.back ().samples.resize (m_samplesPerFlow);
+	m_flows.back ().used = 0;
+	uint32_t length = name.size ();
+	std::fputc ('N', m_file);
+	std::fwrite (&flow, sizeof (flow), 1, m_file);
+	std::fwrite (&length, sizeof (length), 1, m_file);
+	std::fwrite (name.data (), 1, length, m_file);
+	return flow;
+}
+
+inline void
+TcpStateTracer::AddSocket (Ptr<Socket> socket, const std::string& name)
+{
+	Connect (socket, AddFlow (name));
+}
+
+inline void
+TcpStateTracer::AddApplicationSocket (Ptr<Application> app, Time start, const std::string& name)
+{
+	//the socket exists right after the start event of the application
+	Simulator::Schedule (start + NanoSeconds (1), &TcpStateTracer::ConnectApplicationSocket, this, app, AddFlow (name));
+}
+
+inline void
+TcpStateTracer::ConnectApplicationSocket (Ptr<Application> app, uint32_t flow)
+{
+	Ptr<Socket> socket;
+	Ptr<OnOffApplication> onOff = DynamicCast<OnOffApplication> (app);
+	Ptr<BulkSendApplication> bulkSend = DynamicCast<BulkSendApplication> (app);
+	if (onOff != nullptr)
+	{
+		socket = onOff->GetSocket ();
+	}
+	else if (bulkSend != nullptr)
+	{
+		socket = bulkSend->GetSocket ();
+	}
+	if (socket != nullptr)
+	{
+		Connect (socket, flow);
+	}
+}
+
+inline void
+TcpStateTracer::Connect (Ptr<Socket> socket, uint32_t flow)
+{
+	socket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&TcpStateTracer::CwndChanged, this, flow));
+	socket->TraceConnectWithoutContext ("SlowStartThreshold", MakeBoundCallback (&TcpStateTracer::SsthreshChanged, this, flow));
+	socket->TraceConnectWithoutContext ("RTT", MakeBoundCallback (&TcpStateTracer::RttChanged, this, flow));
+	socket->TraceConnectWithoutContext ("CongState", MakeBoundCallback (&TcpStateTracer::CongStateChanged, this, flow));
+}
+
+inline void
+TcpStateTracer::CwndChanged (TcpStateTracer* tracer, uint32_t flow, uint32_t oldValue, uint32_t newValue)
+{
+	tracer->Record (flow, CWND, newValue);
+}
+
+inline void
+TcpStateTracer::SsthreshChanged (TcpStateTracer* tracer, uint32_t flow, uint32_t oldValue, uint32_t newValue)
+{
+	tracer->Record (flow, SSTHRESH, newValue);
+}
+
+inline void
+TcpStateTracer::RttChanged (TcpStateTracer* tracer, uint32_t flow, Time oldValue, Time newValue)
+{
+	tracer->Record (flow, RTT, static_cast<uint32_t> (newValue.GetMicroSeconds ()));
+}
+
+inline void
+TcpStateTracer::CongStateChanged (TcpStateTracer* tracer, uint32_t flow, TcpSocketState::TcpCongState_t oldValue, TcpSocketState::TcpCongState_t newValue)
+{
+	tracer->Record (flow, CONG_STATE, static_cast<uint32_t> (newValue));
+}
+
+inline void
+TcpStateTracer::Record (uint32_t flow, uint8_t kind, uint32_t value)
+{
+	Flow& f = m_flows[flow];
+	if (f.used == f.samples.size ())
+	{
+		WriteFlow (flow);
+	}
+	TcpStateSample& sample = f.samples[f.used++];
+	sample.timeNs = Simulator::Now ().GetNanoSeconds ();
+	sample.value = value;
+	sample.kind = kind;
+	m_samples++;
+}
+
+inline void
+TcpStateTracer::WriteFlow (uint32_t flow)
+{
+	Flow& f = m_flows[flow];
+	if (m_file == nullptr)
+	{
+		//samples traced after Finish () are dropped
+		f.used = 0;
+		return;
+	}
+	if (f.used == 0)
+	{
+		return;
+	}
+	std::fputc ('S', m_file);
+	std::fwrite (&flow, sizeof (flow), 1, m_file);
+	std::fwrite (&f.used, sizeof (f.used), 1, m_file);
+	std::fwrite (f.samples.data (), sizeof (TcpStateSample), f.used, m_file);
+	f.used = 0;
+}
+
+inline void
+TcpStateTracer::Finish (void)
+{
+	if (m_file == nullptr)
+	{
+		return;
+	}
+	for (uint32_t flow = 0; flow < m_flows.size (); flow++)
+	{
+		WriteFlow (flow);
+	}
+	std::fclose (m_file);
+	m_file = nullptr;
+}
+
+inline uint64_t
+TcpStateTracer::GetSampleCount (void) const
+{
+	return m_samples;
+}
+
+inline const char*
+TcpStateTracer::GetKindName (uint8_t kind)
+{
+	switch (kind)
+	{
+		case CWND:
+			return "cwnd";
+		case RTT:
+			return "rtt";
+		case SSTHRESH:
+			return "ssthresh";
+		default:
+			return "congState";
+	}
+}
+
+//convert a binary trace written by TcpStateTracer to "time,flow,name,kind,value" csv lines
+//ordered by flow and time, returns the number of samples converted
+inline uint64_t
+ConvertTcpStateTrace (const std::string& inputName, const std::string& outputName)
+{
+	std::ifstream input (inputName.c_str (), std::ios::binary);
+	char magic[8];
+	uint32_t version = 0;
+	if (!input.read (magic, 8) || std::memcmp (magic, "TCPSTATE", 8) != 0
+	    || !input.read (reinterpret_cast<char*> (&version), sizeof (version)) || version != 1)
+	{
+		NS_FATAL_ERROR ("Not a tcp state trace: " << inputName);
+	}
+
+	std::vector<std::string> names;
+	std::vector<std::vector<TcpStateSample> > samples;
+	char tag;
+	uint32_t flow, count;
+	while (input.get (tag) && input.read (reinterpret_cast<char*> (&flow), sizeof (flow))
+	       && input.read (reinterpret_cast<char*> (&count), sizeof (count)))
+	{
+		if (flow >= names.size ())
+		{
+			names.resize (flow + 1);
+			samples.resize (flow + 1);
+		}
+		if (tag == 'N')
+		{
+			names[flow].resize (count);
+			input.read (&names[flow][0], count);
+		}
+		else
+		{
+			size_t first = samples[flow].size ();
+			samples[flow].resize (first + count);
+			input.read (reinterpret_cast<char*> (&samples[flow][first]), count * sizeof (TcpStateSample));
+		}
+	}
+
+	//the time in seconds with all 9 decimals of the nanoseconds recorded, samples of one ack are
+	//microseconds apart
+	std::ofstream output (outputName.c_str ());
+	output << std::fixed << std::setprecision (9);
+	output << "time,flow,name,kind,value\n";
+	uint64_t converted = 0;
+	for (uint32_t f = 0; f < samples.size (); f++)
+	{
+		for (const TcpStateSample& sample : samples[f])
+		{
+			output << sample.timeNs / 1e9 << "," << f << "," << names[f] << ","
+			       << TcpStateTracer::GetKindName (sample.kind) << "," << sample.value << "\n";
+			converted++;
+		}
+	}
+	return converted;
+}
+
+} // namespace ns3
+
+#endif /* TCP_STATE_TRACER_H */
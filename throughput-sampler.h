@@ -0,0 +1,164 @@
+#ifndef THROUGHPUT_SAMPLER_H
+#define THROUGHPUT_SAMPLER_H
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flow-accounting.h"
+
+namespace ns3
+{
+
+//Periodically reads the received bytes of every flow from a FlowAccounting and writes the
+//throughput of the last interval and the Jain's fairness index over that window to a CSV
+//file. Lines are formatted into a fixed size buffer that is written out whenever it fills
+//up, so memory stays constant no matter how long the simulation runs.
+class ThroughputSampler
+{
+	public:
+		//bufferSize is the number of bytes buffered before they are written to the file
+		ThroughputSampler (const FlowAccounting& accounting, Time interval, const std::string& fileName,
+		                   uint32_t bufferSize = 64 * 1024);
+		~ThroughputSampler ();
+
+		//schedule the first sample, call before Simulator::Run()
+		void Start (void);
+
+		//write out the buffered samples and close the file, call after Simulator::Run()
+		void Finish (void);
+
+	private:
+		//take one sample and schedule the next one
+		void Sample (void);
+
+		//append a formatted line to the buffer, writing the buffer out first if it does not fit
+		void Append (const char* line, int length);
+		void Flush (void);
+
+		const FlowAccounting& m_accounting;
+		Time m_interval;
+		std::FILE* m_file;
+		std::vector<char> m_buffer;
+		uint32_t m_used;
+		std::vector<uint64_t> m_lastRxBytes;
+};
+
+inline
+ThroughputSampler::ThroughputSampler (const FlowAccounting& accounting, Time interval,
+                                      const std::string& fileName, uint32_t bufferSize)
+: m_accounting (accounting),
+m_interval (interval),
+m_file (std::fopen (fileName.c_str (), "w")),
+m_buffer (bufferSize < 256 ? 256 : bufferSize),
+m_used (0)
+{
+	if (m_file == nullptr)
+	{
+		NS_FATAL_ERROR ("Cannot open sample file " << fileName);
+	}
+
+	//the samples are already buffered here, no need for a second stdio buffer
+	std::setvbuf (m_file, nullptr, _IONBF, 0);
+}
+
+inline
+ThroughputSampler::~ThroughputSampler ()
+{
+	Finish ();
+}
+
+inline void
+ThroughputSampler::Start (void)
+{
+	m_lastRxBytes.assign (m_accounting.GetFlows ().size (), 0);
+
+	//header: time, fairness and average of the window, then the throughput of every flow in Kbps
+	std::string header = "time,fairness,avgThroughput";
+	for (size_t i = 0; i < m_lastRxBytes.size (); i++)
+	{
+		header += ",flow" + std::to_string (i);
+	}
+	header += "\n";
+	Append (header.c_str (), header.size ());
+	Simulator::Schedule (m_interval, &ThroughputSampler::Sample, this);
+}
+
+inline void
+ThroughputSampler::Sample (void)
+{
+	//flows that appear after Start() are not part of the columns
+	const std::vector<FlowAccounting::FlowCounters>& flows = m_accounting.GetFlows ();
+	size_t nFlows = std::min (flows.size (), m_lastRxBytes.size ());
+	double seconds = m_interval.GetSeconds ();
+
+	//first pass: windowed throughput sums for the fairness index
+	double sum = 0.0, squareSum = 0.0;
+	for (size_t i = 0; i < nFlows; i++)
+	{
+		double throughput = (flows[i].rxBytes - m_lastRxBytes[i]) * 8.0 / seconds / 1024;
+		sum += throughput;
+		squareSum += throughput * throughput;
+	}
+	double fairness = squareSum > 0 ? (sum * sum) / (nFlows * squareSum) : 0.0;
+
+	char line[64];
+	int n = std::snprintf (line, sizeof (line), "%.6f,%.6f,%.3f", Simulator::Now ().GetSeconds (),
+	                       fairness, nFlows == 0 ? 0.0 : sum / nFlows);
+	Append (line, n);
+	for (size_t i = 0; i < nFlows; i++)
+	{
+		double throughput = (flows[i].rxBytes - m_lastRxBytes[i]) * 8.0 / seconds / 1024;
+		n = std::snprintf (line, sizeof (line), ",%.3f", throughput);
+		Append (line, n);
+		m_lastRxBytes[i] = flows[i].rxBytes;
+	}
+	Append ("\n", 1);
+
+	Simulator::Schedule (m_interval, &ThroughputSampler::Sample, this);
+}
+
+inline void
+ThroughputSampler::Append (const char* line, int length)
+{
+	if (m_used + length > m_buffer.size ())
+	{
+		Flush ();
+	}
+	if (static_cast<size_t> (length) > m_buffer.size ())
+	{
+		std::fwrite (line, 1, length, m_file);
+		return;
+	}
+	std::copy (line, line + length, m_buffer.begin () + m_used);
+	m_used += length;
+}
+
+inline void
+ThroughputSampler::Flush (void)
+{
+	if (m_file != nullptr && m_used > 0)
+	{
+		std::fwrite (m_buffer.data (), 1, m_used, m_file);
+	}
+	m_used = 0;
+}
+
+inline void
+ThroughputSampler::Finish (void)
+{
+	Flush ();
+	if (m_file != nullptr)
+	{
+		std::fclose (m_file);
+		m_file = nullptr;
+	}
+}
+
+} // namespace ns3
+
+#endif /* THROUGHPUT_SAMPLER_H */
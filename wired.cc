@@ -6,7 +6,36 @@
 #include "ns3/flow-monitor.h"
 #include "ns3/gnuplot.h"
 #include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
 #include "ns3/netanim-module.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+//the replaced global operator new counts every allocation of the program, only compiled in
+//when built with -DCOUNT_ALLOCATIONS
+#ifdef COUNT_ALLOCATIONS
+#include "alloc-counter.h"
+#endif
+#include "dumbbell-builder.h"
+#include "adaptive-sweep.h"
+#include "animation-stream.h"
+#include "fct-workload.h"
+#include "flow-accounting.h"
+#include "flow-sketch.h"
+#include "latency-histogram.h"
+#include "queue-monitor.h"
+#include "replication-stats.h"
+#include "result-cache.h"
+#include "result-writer.h"
+#include "routing-mode.h"
+#include "sampled-capture.h"
+#include "scheduler-type.h"
+#include "sim-benchmark.h"
+#include "steady-state-monitor.h"
+#include "throughput-sampler.h"
+#include "sweep-runner.h"
+#include "tcp-state-tracer.h"
 
 using namespace ns3;
 
@@ -16,15 +45,23 @@ NS_LOG_COMPONENT_DEFINE("TCPWiredProgram");
 class MyApp : public Application
 {
 	public:
+		//register the class and its trace sources with the ns-3 type system
+		static TypeId GetTypeId (void);
+
 		//constructor
 		MyApp ();
 		
 		//destructor
 		virtual ~MyApp();
     
-		//function to initialize variables
+		//function to initialize variables, maxBytes = 0 sends until the application is stopped
+		//bulkSend fills the socket tx buffer instead of sending one packet per timer event
 		void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, 
-		uint32_t nPackets, DataRate dataRate);
+		uint64_t maxBytes, DataRate dataRate, bool bulkSend = false);
+
+		//send copy-on-write copies of one preallocated zero-filled packet instead of
+		//allocating a new packet for every transmission
+		void SetPacketReuse (bool reuse);
   
 	private:
 		//functions to execute when application is started
@@ -38,28 +75,68 @@ class MyApp : public Application
 
 		//function to send packet
 		void SendPacket (void);
+
+		//function returning a packet of the given size to send
+		Ptr<Packet> NewPacket (uint32_t size);
+
+		//function firing the tx trace for a packet handed to the socket
+		void NotifyTx (Ptr<const Packet> packet);
+
+		//function to send packets while there is space in the socket tx buffer (bulk mode)
+		void SendData (void);
+
+		//callback when the connection to the sink is established (bulk mode)
+		void ConnectionSucceeded (Ptr<Socket> socket);
+
+		//callback when acknowledged data frees space in the socket tx buffer (bulk mode)
+		void DataSend (Ptr<Socket> socket, uint32_t available);
   
 		//variable declarations
 		Ptr<Socket>     m_socket;
 		Address         m_peer;
 		uint32_t        m_packetSize;
-		uint32_t        m_nPackets;
+		uint64_t        m_maxBytes;
 		DataRate        m_dataRate;
 		EventId         m_sendEvent;
 		bool            m_running;
-		uint32_t        m_packetsSent;    
+		bool            m_bulkSend;
+		bool            m_connected;
+		uint64_t        m_bytesSent;
+		bool            m_reusePacket;
+		Ptr<Packet>     m_packetTemplate;
+
+		//trace of the packets sent with the local and the peer address
+		TracedCallback<Ptr<const Packet>, const Address&, const Address&> m_txTrace;    
 };
 
+NS_OBJECT_ENSURE_REGISTERED (MyApp);
+
+TypeId MyApp::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("MyApp")
+		.SetParent<Application> ()
+		.SetGroupName ("Applications")
+		.AddConstructor<MyApp> ()
+		.AddTraceSource ("TxWithAddresses", "A packet has been sent to the socket",
+		                 MakeTraceSourceAccessor (&MyApp::m_txTrace),
+		                 "ns3::Packet::TwoAddressTracedCallback");
+	return tid;
+}
+
 //initializing variables with default values in constructor  
 MyApp::MyApp ()
 : m_socket (0),
 m_peer (),
 m_packetSize (0),
-m_nPackets (0),
+m_maxBytes (0),
 m_dataRate (0),
 m_sendEvent (),
 m_running (false),
-m_packetsSent (0)
+m_bulkSend (false),
+m_connected (false),
+m_bytesSent (0),
+m_reusePacket (false),
+m_packetTemplate (0)
 {
 }
   
@@ -67,28 +144,43 @@ m_packetsSent (0)
 MyApp::~MyApp()
 {
 	m_socket = 0;
+	m_packetTemplate = 0;
 	//std::cout << "Destroyed";
 }
   
 //initializing variables with argument values
-void MyApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint32_t nPackets, DataRate dataRate)
+void MyApp::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, uint64_t maxBytes, DataRate dataRate, bool bulkSend)
 {
 	m_socket = socket;
 	m_peer = address;
 	m_packetSize = packetSize;
-	m_nPackets = nPackets;
+	m_maxBytes = maxBytes;
 	m_dataRate = dataRate;
+	m_bulkSend = bulkSend;
 	//std::cout << "Setup Done\n" ;
 }
 
+//enable or disable sending copies of a prototype packet
+void MyApp::SetPacketReuse (bool reuse)
+{
+	m_reusePacket = reuse;
+}
+
 
 void MyApp::StartApplication (void)
 {
 	//application running status is set to true
 	m_running = true;
     
-	//Number of packets initialized to 0
-	m_packetsSent = 0;
+	//Number of bytes sent initialized to 0
+	m_bytesSent = 0;
+	m_connected = false;
+
+	//build the zero-filled prototype packet once, every send only copies it
+	if (m_reusePacket)
+	{
+		m_packetTemplate = Create<Packet> (m_packetSize);
+	}
     
 	//std::cout << "Application Started\n" ;
     
@@ -96,12 +188,23 @@ void MyApp::StartApplication (void)
 	m_socket->Bind ();
 	//std::cout << "Bind Successful\n" ;
     
+	//in bulk mode the socket tells us when it is connected and when there is space to send more
+	if (m_bulkSend)
+	{
+		m_socket->SetConnectCallback (MakeCallback (&MyApp::ConnectionSucceeded, this),
+		                              MakeNullCallback<void, Ptr<Socket> > ());
+		m_socket->SetSendCallback (MakeCallback (&MyApp::DataSend, this));
+	}
+    
 	//connect with sink node
 	m_socket->Connect (m_peer);
 	//std::cout << "Connection Establishhed\n" ;
     
 	//send packet from source to sink
-	SendPacket ();
+	if (!m_bulkSend)
+	{
+		SendPacket ();
+	}
 }
   
 void MyApp::StopApplication (void)
@@ -127,19 +230,87 @@ void MyApp::StopApplication (void)
 void MyApp::SendPacket (void)
 {
 	//create packet of size m_packetSize using dummy data
-	Ptr<Packet> packet = Create<Packet> (m_packetSize);
+	Ptr<Packet> packet = NewPacket (m_packetSize);
     
 	//send the packet
-	m_socket->Send (packet);
+	if (m_socket->Send (packet) >= 0)
+	{
+		NotifyTx (packet);
+	}
   	
 	//std::cout << "Packet Sent of size " << m_packetSize << "\n";	
     
-	//if all packets are not sent, schedule the next packet
-	if (++m_packetsSent < m_nPackets)
+	//if all bytes are not sent, schedule the next packet
+	m_bytesSent += m_packetSize;
+	if (m_maxBytes == 0 || m_bytesSent < m_maxBytes)
 	{
 		ScheduleTx ();
 	}
 }
+
+//function to create a packet of the given size using dummy data, the copy of the prototype
+//shares its zero-filled buffer so no payload has to be allocated
+Ptr<Packet> MyApp::NewPacket (uint32_t size)
+{
+	if (m_packetTemplate && size == m_packetSize)
+	{
+		return m_packetTemplate->Copy ();
+	}
+	return Create<Packet> (size);
+}
+
+//function firing the tx trace, the local address is only looked up when someone listens
+void MyApp::NotifyTx (Ptr<const Packet> packet)
+{
+	if (!m_txTrace.IsEmpty ())
+	{
+		Address localAddress;
+		m_socket->GetSockName (localAddress);
+		m_txTrace (packet, localAddress, m_peer);
+	}
+}
+
+//function to fill the socket tx buffer in one batch, it is called again by DataSend once
+//acknowledgements free up space so no simulator event is needed per packet
+void MyApp::SendData (void)
+{
+	while (m_running && (m_maxBytes == 0 || m_bytesSent < m_maxBytes))
+	{
+		uint32_t toSend = m_packetSize;
+		if (m_maxBytes > 0 && m_maxBytes - m_bytesSent < toSend)
+		{
+			toSend = m_maxBytes - m_bytesSent;
+		}
+		
+		//stop when the tx buffer is full, the send callback wakes us up again
+		if (m_socket->GetTxAvailable () < toSend)
+		{
+			break;
+		}
+		Ptr<Packet> packet = NewPacket (toSend);
+		int sent = m_socket->Send (packet);
+		if (sent <= 0)
+		{
+			break;
+		}
+		NotifyTx (packet);
+		m_bytesSent += sent;
+	}
+}
+
+void MyApp::ConnectionSucceeded (Ptr<Socket> socket)
+{
+	m_connected = true;
+	SendData ();
+}
+
+void MyApp::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+	if (m_connected)
+	{
+		SendData ();
+	}
+}
   
 //function to schedule packet transmission
 void MyApp::ScheduleTx (void)
@@ -153,16 +324,1144 @@ void MyApp::ScheduleTx (void)
 	}
 }
 
+//options of the wired scenario that stay the same for every sweep point
+struct WiredConfig
+{
+	bool bulkSend;          //fill the socket tx buffer instead of one timer event per packet
+	uint64_t maxBytes;      //bytes sent by every flow, 0 uses nPackets
+	uint32_t nPackets;      //packets sent by every flow when maxBytes is 0, 0 is unlimited
+	bool reusePacket;       //send copies of a prototype packet instead of allocating every packet
+	std::string accounting; //"flowmon" for FlowMonitor, "trace" for the trace based flow accounting or "sketch" for the bounded memory one
+	double sampleInterval;  //interval of the throughput/fairness time series in seconds, 0 disables it
+	bool steadyState;       //stop every sweep point once the flows have converged
+	double steadyWindow;    //length of one throughput window of the convergence monitor in seconds
+	uint32_t steadyHistory; //number of windows compared by the convergence monitor
+	double steadyTolerance; //relative change of mean and deviation accepted as converged
+	double warmup;          //time before which windows are discarded (slow start) in seconds
+	bool dumbbell;          //simulate the multi-sender dumbbell (split over 2 mpi ranks under mpirun -np 2)
+	uint32_t senders;       //number of sender hosts of the dumbbell
+	uint32_t receivers;     //number of receiver hosts of the dumbbell
+	uint32_t flowsPerSender;//flows started by every sender host
+	std::string ccMix;      //comma separated congestion control types assigned to the flows round robin
+	std::string routing;    //"global", "nix" or "static" routing, empty uses global for the wired and static for the dumbbell topology
+	std::string scheduler;  //"map", "heap", "calendar", "list" or "priority" event scheduler, empty keeps the default
+	bool queueMonitor;      //record occupancy, sojourn time and per-flow drops of the r1-r2 bottleneck queue
+	bool tcpTrace;          //record cwnd, rtt, ssthresh and congestion state of every flow to a binary file
+	uint32_t tcpTraceBuffer;//samples buffered per flow before the tcp state trace is written out
+	bool fct;               //run the flow completion time workload on the dumbbell instead of long flows
+	std::string fctCdf;     //flow size cdf file of the workload, empty uses the web search distribution
+	double fctLoad;         //offered load of the workload as a fraction of the bottleneck rate
+	double fctDuration;     //time during which flows arrive in seconds
+	double fctDrain;        //time after the last arrival given to the flows to complete in seconds
+	double fctTimeWait;     //TIME_WAIT of the closed workload sockets in seconds
+	std::string capture;    //"packets" or "flows" sampling of the header capture of the bottleneck devices, empty disables it
+	uint32_t captureOneIn;  //one in this many packets or flows is captured
+	uint32_t captureRecords;//records held by the capture ring
+	uint32_t captureSnap;   //bytes kept of every captured packet
+	uint32_t captureDropBurst;//drops within 100ms dumping the capture ring, 0 disables the trigger
+	double captureCollapse; //fraction of its previous value a cwnd falls below to dump the capture ring, 0 disables the trigger
+	bool latency;           //record one-way delay and jitter histograms of every flow and congestion control
+	uint32_t sketchTopFlows;//flows with the most received bytes listed with exact counters by the sketch accounting
+	uint32_t sketchMaxActive;//flows tracked at the same time by the sketch accounting before the oldest is folded
+	double sketchIdle;      //time without packets after which the sketch accounting folds a flow in seconds, 0 only folds evicted flows
+	double sketchAccuracy;  //relative error of the delay and jitter quantiles of the sketch accounting
+	bool anim;              //write a NetAnim trace of every sweep point
+	uint32_t animEvery;     //every this many packets is animated
+	std::string animWindows;//"start-stop,..." times in seconds outside of which no packet is animated, empty animates the whole run
+	bool animCompress;      //pipe the animation through gzip
+	uint32_t animBuffer;    //bytes of animation xml buffered before they are written out
+
+	//links and applications given in assignment, not options; the result cache key is built from them too
+	std::string accessRate; //data rate of the n2-r1 and r2-n3 links and of the dumbbell host links
+	std::string accessDelay;//delay of the n2-r1 and r2-n3 links and of the dumbbell host links
+	std::string bottleneckRate;//data rate of the r1-r2 link
+	std::string bottleneckDelay;//delay of the r1-r2 link
+	uint32_t queueBytes;    //droptail queue of the r1-r2 link in bytes, its bandwidth-delay product
+	std::string appRate;    //data rate of the MyApp sources
+	uint16_t sinkPort;      //port of the packet sinks and of the workload receivers
+	double sinkStart;       //time the packet sinks start in seconds
+	double appStart;        //time the sources and the flow arrivals start in seconds
+	double appStop;         //time the sources and the packet sinks stop in seconds
+	double simStop;         //time the simulation of the long flows stops in seconds
+
+	WiredConfig ()
+	: bulkSend (false),
+	maxBytes (0),
+	nPackets (100),
+	reusePacket (false),
+	accounting ("flowmon"),
+	sampleInterval (0),
+	steadyState (false),
+	steadyWindow (0.1),
+	steadyHistory (20),
+	steadyTolerance (0.05),
+	warmup (2.0),
+	dumbbell (false),
+	senders (1),
+	receivers (1),
+	flowsPerSender (3),
+	ccMix ("ns3::TcpWestwood,ns3::TcpVeno,ns3::TcpVegas"),
+	routing (""),
+	scheduler (""),
+	queueMonitor (false),
+	tcpTrace (false),
+	tcpTraceBuffer (1024),
+	fct (false),
+	fctCdf (""),
+	fctLoad (0.5),
+	fctDuration (10),
+	fctDrain (5),
+	fctTimeWait (1),
+	capture (""),
+	captureOneIn (100),
+	captureRecords (4096),
+	captureSnap (64),
+	captureDropBurst (10),
+	captureCollapse (0.25),
+	latency (false),
+	sketchTopFlows (10),
+	sketchMaxActive (65536),
+	sketchIdle (0),
+	sketchAccuracy (0.01),
+	anim (false),
+	animEvery (1),
+	animWindows (""),
+	animCompress (true),
+	animBuffer (65536),
+	accessRate ("100Mbps"),
+	accessDelay ("20ms"),
+	bottleneckRate ("10Mbps"),
+	bottleneckDelay ("50ms"),
+	queueBytes (6250),
+	appRate ("100Mbps"),
+	sinkPort (8080),
+	sinkStart (0.0),
+	appStart (1.0),
+	appStop (10.0),
+	simStop (15.0)
+	{
+	}
+};
+
+//congestion control of the three flows of the wired topology, in the order their sockets are created
+const char* const WIRED_TCP_TYPES[3] = {"ns3::TcpWestwood", "ns3::TcpVeno", "ns3::TcpVegas"};
+
+//time the bottleneck takes to send a full device queue, the sojourn bucket of the queue monitor
+Time GetQueueDrainTime(const WiredConfig& config)
+{
+	return DataRate(config.bottleneckRate).CalculateBytesTxTime(config.queueBytes);
+}
+
+//simulate the wired topology for one packet size and collect the per-flow statistics
+SweepPointResult SimulateWired(const SweepJob& job, const WiredConfig& config)
+{
+	//ps stores current packet size
+	uint32_t ps = job.packetSize;
+	
+	//measure the memory and time used by this sweep point
+	RunProbe probe;
+	probe.Start();
+	
+	//number of bytes every source application sends
+	uint64_t flowBytes = config.maxBytes > 0 ? config.maxBytes : static_cast<uint64_t>(config.nPackets) * ps;
+	
+	//select the rng run so that every replication sees independent random streams
+	RngSeedManager::SetRun(job.run);
+	SelectScheduler(config.scheduler);
+	
+	//create the 4 nodes needed along with containers
+	NodeContainer n2;
+	n2.Create(1);
+    
+	NodeContainer n3;
+	n3.Create(1);
+    
+	NodeContainer r1;
+	r1.Create(1);
+    
+	NodeContainer r2;
+	r2.Create(1);
+    
+	//add r1 node to n2 container
+	n2.Add(r1);
+    
+	//declare helper for creating point-to-point link and set data rate and delay values given in assignment
+	PointToPointHelper pointToPoint1;
+	pointToPoint1.SetDeviceAttribute("DataRate", StringValue(config.accessRate));
+	pointToPoint1.SetChannelAttribute("Delay", StringValue(config.accessDelay));
+ 
+	//install the devices n2 and r1 as end points of the point-to-point channel
+	NetDeviceContainer n2r1;
+	n2r1 = pointToPoint1.Install(n2);
+    
+	//add r2 node to r1 container
+	r1.Add(r2);
+    
+	//declare helper for creating point-to-point link and set data rate and delay values given in assignment
+	PointToPointHelper pointToPoint2;
+	pointToPoint2.SetDeviceAttribute("DataRate", StringValue(config.bottleneckRate));
+	pointToPoint2.SetChannelAttribute("Delay", StringValue(config.bottleneckDelay));
+ 
+	//set droptail queue with size as bandwidth-delay product
+	pointToPoint2.SetQueue ("ns3::DropTailQueue", "MaxSize", QueueSizeValue(QueueSize(QueueSizeUnit::BYTES, config.queueBytes)));
+    
+	//install the devices r1 and r2 as end points of the point-to-point channel
+	NetDeviceContainer r1r2;
+	r1r2 = pointToPoint2.Install(r1);
+    
+	//add n3 node to r2 container
+	r2.Add(n3);
+    
+	//declare helper for creating point-to-point link and set data rate and delay values given in assignment
+	PointToPointHelper pointToPoint3;
+	pointToPoint3.SetDeviceAttribute("DataRate", StringValue(config.accessRate));
+	pointToPoint3.SetChannelAttribute("Delay", StringValue(config.accessDelay));
+    
+	//install the devices r2 and n3 as end points of the point-to-point channel
+	NetDeviceContainer r2n3;
+	r2n3 = pointToPoint3.Install(r2);
+    
+	//add r2 node to n2 container
+	//this fills n2 container with all 4 nodes n2,r1,r2,n3
+	n2.Add(r2);
+    
+	//install internet stack on all nodes, with nix-vector routing if selected
+	RoutingMode routing = ParseRoutingMode(config.routing, ROUTING_GLOBAL);
+	InternetStackHelper stack;
+	SetStackRouting(stack, routing);
+	stack.Install(n2);
+   
+	//assign ipv4 addresses to all devices
+	Ipv4AddressHelper address;
+
+	address.SetBase("10.1.1.0", "255.255.255.0");
+
+	Ipv4InterfaceContainer n2r1Interfaces = address.Assign(n2r1);
+    
+	address.SetBase("10.1.2.0", "255.255.255.0");
+
+	Ipv4InterfaceContainer r1r2Interfaces = address.Assign(r1r2);
+    
+	address.SetBase("10.1.3.0", "255.255.255.0");
+
+	Ipv4InterfaceContainer r2n3Interfaces = address.Assign(r2n3);
+
+	//use global routing and create routing tables, or give every node a default route towards the other side
+	AddDefaultRoute(routing, n2r1.Get(0), n2r1Interfaces.GetAddress(1));
+	AddDefaultRoute(routing, r1r2.Get(0), r1r2Interfaces.GetAddress(1));
+	AddDefaultRoute(routing, r1r2.Get(1), r1r2Interfaces.GetAddress(0));
+	AddDefaultRoute(routing, r2n3.Get(1), r2n3Interfaces.GetAddress(0));
+	PopulateRoutes(routing);
+    
+	    	
+	//use sink port as 8080	    
+	uint16_t sinkPort = config.sinkPort;
+	    
+	//create socket and tcp sink application and install it on node n3
+	Address sinkAddress (InetSocketAddress(r2n3Interfaces.GetAddress (1), sinkPort));
+	PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
+	ApplicationContainer sinkApps = packetSinkHelper.Install (n3.Get (0));
+	sinkApps.Start (Seconds (config.sinkStart));
+	sinkApps.Stop (Seconds (config.appStop));
+	    
+	  
+	//create socket for tcp source node n2 with congestion control algorithm as Westwood
+	//the socket type is set directly on the tcp protocol of n2 instead of through a Config path
+	Ptr<Socket> ns3TcpSocket = DumbbellBuilder::CreateTcpSocket (n2.Get (0), TypeId::LookupByName(WIRED_TCP_TYPES[0]));
+	    
+	//create and install tcp source application with congestion control algorithm as Westwood on node n2 using our custom made application class "MyApp"
+	Ptr<MyApp> app = CreateObject<MyApp> ();
+	app->Setup (ns3TcpSocket, sinkAddress, ps, flowBytes, DataRate (config.appRate), config.bulkSend);
+	app->SetPacketReuse (config.reusePacket);
+	n2.Get (0)->AddApplication (app);
+	app->SetStartTime(Seconds(config.appStart));
+	app->SetStopTime(Seconds(config.appStop));
+	    
+	//create socket for tcp source node n2 with congestion control algorithm as Veno
+	Ptr<Socket> ns3TcpSocket2 = DumbbellBuilder::CreateTcpSocket (n2.Get (0), TypeId::LookupByName(WIRED_TCP_TYPES[1]));
+	    
+	//create and install tcp source application with congestion control algorithm as Veno on node n2 using our custom made application class "MyApp"
+	Ptr<MyApp> app2 = CreateObject<MyApp> ();
+	app2->Setup (ns3TcpSocket2, sinkAddress, ps, flowBytes, DataRate (config.appRate), config.bulkSend);
+	app2->SetPacketReuse (config.reusePacket);
+	n2.Get (0)->AddApplication (app2);
+	app2->SetStartTime(Seconds(config.appStart));
+	app2->SetStopTime(Seconds(config.appStop));
+	    
+	//create socket for tcp source node n2 with congestion control algorithm as Vegas
+	Ptr<Socket> ns3TcpSocket3 = DumbbellBuilder::CreateTcpSocket (n2.Get (0), TypeId::LookupByName(WIRED_TCP_TYPES[2]));
+	    
+	//create and install tcp source application with congestion control algorithm as Vegas on node n2 using our custom made application class "MyApp" 
+	Ptr<MyApp> app3 = CreateObject<MyApp> ();
+	app3->Setup (ns3TcpSocket3, sinkAddress, ps, flowBytes, DataRate (config.appRate), config.bulkSend);
+	app3->SetPacketReuse (config.reusePacket);
+	n2.Get (0)->AddApplication (app3);
+	app3->SetStartTime(Seconds(config.appStart));
+	app3->SetStopTime(Seconds(config.appStop));
+	
+	//trace the congestion control state of the three sockets
+	std::unique_ptr<TcpStateTracer> tcpTracer;
+	if(config.tcpTrace)
+	{
+		std::ostringstream traceFileName;
+		traceFileName << "Wired-TcpState-" << ps << "-" << job.run << ".bin";
+		tcpTracer.reset(new TcpStateTracer(traceFileName.str(), config.tcpTraceBuffer));
+		tcpTracer->AddSocket(ns3TcpSocket, "Westwood");
+		tcpTracer->AddSocket(ns3TcpSocket2, "Veno");
+		tcpTracer->AddSocket(ns3TcpSocket3, "Vegas");
+	}
+	       
+	//create flow monitor, or only hook the application traces for the lightweight accounting
+	Ptr<FlowMonitor> flowMonitor;
+	FlowMonitorHelper flowHelper;
+	FlowAccounting accounting;
+	//the sources are also hooked for flow monitor, which finds the congestion control of a flow by its source port
+	if(config.accounting != "sketch" || config.sampleInterval > 0 || config.steadyState)
+	{
+		accounting.AddSource(app, "Westwood");
+		accounting.AddSource(app2, "Veno");
+		accounting.AddSource(app3, "Vegas");
+	}
+	if(config.accounting == "trace" || config.sampleInterval > 0 || config.steadyState)
+	{
+		accounting.AddSink(sinkApps.Get(0));
+	}
+	std::unique_ptr<SketchAccounting> sketch;
+	if(config.accounting == "sketch")
+	{
+		sketch.reset(new SketchAccounting(config.sketchTopFlows, config.sketchMaxActive, Seconds(config.sketchIdle), config.sketchAccuracy));
+		sketch->AddSource(app, "Westwood");
+		sketch->AddSource(app2, "Veno");
+		sketch->AddSource(app3, "Vegas");
+		sketch->AddSink(sinkApps.Get(0));
+		sketch->Start();
+	}
+	else if(config.accounting != "trace")
+	{
+		flowMonitor = flowHelper.InstallAll();
+	}
+	
+	//delay and jitter histograms of the three flows
+	std::unique_ptr<LatencyTracker> latency;
+	if(config.latency)
+	{
+		latency.reset(new LatencyTracker(true));
+		latency->AddSource(app, "Westwood");
+		latency->AddSource(app2, "Veno");
+		latency->AddSource(app3, "Vegas");
+		latency->AddSink(sinkApps.Get(0));
+	}
+	
+	//stream the windowed throughput and fairness of the flows to a file while the simulation runs
+	std::unique_ptr<ThroughputSampler> sampler;
+	if(config.sampleInterval > 0)
+	{
+		std::ostringstream sampleFileName;
+		sampleFileName << "Wired-Samples-" << ps << "-" << job.run << ".csv";
+		sampler.reset(new ThroughputSampler(accounting, Seconds(config.sampleInterval), sampleFileName.str()));
+		sampler->Start();
+	}
+	
+	//stop the simulation early once the throughput of all flows has converged
+	std::unique_ptr<SteadyStateMonitor> steadyMonitor;
+	if(config.steadyState)
+	{
+		steadyMonitor.reset(new SteadyStateMonitor(accounting, Seconds(config.steadyWindow), config.steadyHistory, config.steadyTolerance, Seconds(config.warmup)));
+		steadyMonitor->Start();
+	}
+	
+	//histograms of the r1 side of the bottleneck, queue disc and device queue together: buckets of
+	//the device queue size and sojourn buckets of the time to drain it (5ms for 6250 bytes at 10Mbps)
+	std::unique_ptr<QueueMonitor> queueMonitor;
+	if(config.queueMonitor)
+	{
+		queueMonitor.reset(new QueueMonitor(config.queueBytes, 32, GetQueueDrainTime(config), 40));
+		queueMonitor->Install(DynamicCast<PointToPointNetDevice>(r1r2.Get(0)));
+	}
+	
+	//sampled header capture of both r1-r2 devices, dumped when the bottleneck queue disc drops a burst
+	//or a flow times out
+	std::unique_ptr<SampledCapture> capture;
+	if(!config.capture.empty())
+	{
+		std::ostringstream capturePrefix;
+		capturePrefix << "Wired-Capture-" << ps << "-" << job.run;
+		capture.reset(new SampledCapture(capturePrefix.str(), config.captureRecords, config.captureSnap));
+		capture->SetSampling(ParseCaptureMode(config.capture), config.captureOneIn);
+		capture->SetDropBurstTrigger(config.captureDropBurst, MilliSeconds(100));
+		capture->SetCwndCollapseTrigger(config.captureCollapse);
+		capture->InstallPointToPoint(DynamicCast<PointToPointNetDevice>(r1r2.Get(0)));
+		capture->InstallPointToPoint(DynamicCast<PointToPointNetDevice>(r1r2.Get(1)));
+		capture->AddQueueDropTraces(r1r2.Get(0));
+		capture->AddCwndTrace(ns3TcpSocket);
+		capture->AddCwndTrace(ns3TcpSocket2);
+		capture->AddCwndTrace(ns3TcpSocket3);
+	}
+	    
+	//decimated NetAnim trace of the three links, the nodes in a row n2 r1 r2 n3
+	std::unique_ptr<AnimationStream> animation;
+	if(config.anim)
+	{
+		std::ostringstream animFileName;
+		animFileName << "Wired-Anim-" << ps << "-" << job.run << (config.animCompress ? ".xml.gz" : ".xml");
+		animation.reset(new AnimationStream(animFileName.str(), config.animBuffer));
+		animation->SetDecimation(config.animEvery);
+		ParseAnimationWindows(config.animWindows, *animation);
+		animation->AddNode(n2.Get(0), 0.0, 0.0);
+		animation->AddNode(r1.Get(0), 2.0, 0.0);
+		animation->AddNode(r2.Get(0), 4.0, 0.0);
+		animation->AddNode(n3.Get(0), 6.0, 0.0);
+		animation->AddDevices(n2r1);
+		animation->AddDevices(r1r2);
+		animation->AddDevices(r2n3);
+	}
+	Simulator::Stop(Seconds(config.simStop));
+	
+#ifdef COUNT_ALLOCATIONS
+	uint64_t allocationsBefore = GetHeapAllocations();
+#endif
+	probe.BeginRun();
+	Simulator::Run();
+	probe.EndRun();
+	if(sampler) sampler->Finish();
+	if(tcpTracer) tcpTracer->Finish();
+	if(capture) capture->Finish();
+	if(animation) animation->Finish();
+#ifdef COUNT_ALLOCATIONS
+	uint64_t allocations = GetHeapAllocations() - allocationsBefore;
+#endif
+		    
+	SweepPointResult result;
+	result.packetSize = ps;
+	result.run = job.run;
+	if(flowMonitor)
+	{
+		//obtain the flow statistics from flow monitor
+		const FlowMonitor :: FlowStatsContainer& fsc = flowMonitor->GetFlowStats();
+		FlowMonitor :: FlowStatsContainerCI it;
+		    
+		//throughput is calculated as (number of bits received by sink) / (time when last packet was received - time when first packet was transmitted)
+		//jain's fairness index = (sum of throughputs)^2 / (number of flows * sum of squares of throughputs)
+		//over all 6 flows, and separately over the data flows to the sink only to compare with the trace accounting
+		Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowHelper.GetClassifier());
+		double throughput_sum = 0.0, throughput_square_sum = 0.0;
+		double data_throughput_sum = 0.0, data_throughput_square_sum = 0.0;
+		uint32_t dataFlows = 0;
+		    
+		for(it = fsc.begin() ; it != fsc.end(); it++)
+		{
+			const FlowMonitor :: FlowStats& fs = it->second;
+		   
+			FlowResult flow;
+			flow.flowId = it->first;
+			flow.rxBytes = fs.rxBytes;
+			flow.firstTx = fs.timeFirstTxPacket.GetSeconds();
+			flow.lastRx = fs.timeLastRxPacket.GetSeconds();
+			
+			//mean one-way delay and jitter of the flow from the sums kept by flow monitor
+			if(fs.rxPackets > 0) result.metrics["flowmonDelayMeanMs." + std::to_string(flow.flowId)] = 1000 * fs.delaySum.GetSeconds() / fs.rxPackets;
+			if(fs.rxPackets > 1) result.metrics["flowmonJitterMeanMs." + std::to_string(flow.flowId)] = 1000 * fs.jitterSum.GetSeconds() / (fs.rxPackets - 1);
+			    
+			double throughput = (flow.rxBytes * 8.0) / (flow.lastRx - flow.firstTx);
+			flow.throughput = throughput / 1024;
+			throughput_sum += flow.throughput;
+			throughput_square_sum += flow.throughput * flow.throughput;
+			
+			//data flows are sent from the port of a source, the ACK flows back to it
+			Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow(it->first);
+			if(tuple.destinationPort == sinkPort)
+			{
+				flow.type = accounting.GetFlowType(tuple.sourceAddress, tuple.sourcePort);
+				data_throughput_sum += flow.throughput;
+				data_throughput_square_sum += flow.throughput * flow.throughput;
+				dataFlows++;
+			}
+			else
+			{
+				flow.type = accounting.GetFlowType(tuple.destinationAddress, tuple.destinationPort);
+			}
+			result.flows.push_back(flow);
+		}
+		    
+		result.avgThroughput = throughput_sum / 6.0;
+		result.fairness = (throughput_sum * throughput_sum) / (6.0 * throughput_square_sum);
+		if(dataFlows > 0 && data_throughput_square_sum > 0)
+		{
+			result.metrics["flowmonDataAvgThroughput"] = data_throughput_sum / dataFlows;
+			result.metrics["flowmonDataFairness"] = (data_throughput_sum * data_throughput_sum) / (dataFlows * data_throughput_square_sum);
+		}
+	}
+	else if(sketch)
+	{
+		//top flows, aggregates and delay quantiles of the bounded memory accounting
+		sketch->FillResult(result);
+	}
+	else
+	{
+		//per-flow counters collected from the application traces
+		accounting.FillResult(result);
+	}
+	probe.AddMetrics(result.metrics);
+	if(queueMonitor) queueMonitor->AddMetrics(result.metrics);
+	if(steadyMonitor) steadyMonitor->AddMetrics(result.metrics);
+	if(latency) latency->AddMetrics(result.metrics);
+	if(capture) capture->AddMetrics(result.metrics);
+	if(animation) animation->AddMetrics(result.metrics);
+#ifdef COUNT_ALLOCATIONS
+	result.metrics["allocations"] = allocations;
+#endif
+	result.ok = true;
+		    
+	Simulator::Destroy();
+	return result;
+}
+
+//rank of this process in the distributed simulation and the number of ranks (0 and 1 without mpi)
+uint32_t GetRank(void)
+{
+#ifdef NS3_MPI
+	if(MpiInterface::IsEnabled()) return MpiInterface::GetSystemId();
+#endif
+	return 0;
+}
+
+uint32_t GetRankCount(void)
+{
+#ifdef NS3_MPI
+	if(MpiInterface::IsEnabled()) return MpiInterface::GetSize();
+#endif
+	return 1;
+}
+
+//release mpi at the end of the program
+void FinishMpi(void)
+{
+#ifdef NS3_MPI
+	if(MpiInterface::IsEnabled()) MpiInterface::Disable();
+#endif
+}
+
+//split a comma separated list of congestion control type names
+std::vector<std::string> SplitTypeNames(const std::string& list)
+{
+	std::vector<std::string> names;
+	std::stringstream stream(list);
+	std::string name;
+	while(std::getline(stream, name, ','))
+	{
+		if(!name.empty()) names.push_back(name);
+	}
+	return names;
+}
+
+//set the dumbbell shape of the configuration on a builder
+void ConfigureDumbbell(DumbbellBuilder& builder, const WiredConfig& config)
+{
+	builder.SetSenders(config.senders);
+	builder.SetReceivers(config.receivers);
+	builder.SetFlowsPerSender(config.flowsPerSender);
+	builder.SetCongestionControlMix(SplitTypeNames(config.ccMix));
+	builder.SetAccessLink(config.accessRate, config.accessDelay);
+	builder.SetBottleneckLink(config.bottleneckRate, config.bottleneckDelay, config.queueBytes);
+	builder.SetRoutingMode(ParseRoutingMode(config.routing, ROUTING_STATIC));
+	builder.SetRanks(GetRank(), GetRankCount());
+}
+
+//simulate a dumbbell with config.senders hosts behind r1 and config.receivers hosts behind r2,
+//every sender running config.flowsPerSender flows with the congestion control mix config.ccMix.
+//When run under mpirun -np 2 the receiver side is simulated by rank 0 and r1 with the sender
+//hosts by rank 1, so the 10Mbps/50ms r1-r2 bottleneck is the remote link and its delay is the
+//lookahead of the distributed simulator. Flows are then learned at the sinks, so only rank 0
+//returns statistics.
+SweepPointResult SimulateDumbbell(const SweepJob& job, const WiredConfig& config)
+{
+	//ps stores current packet size
+	uint32_t ps = job.packetSize;
+	RngSeedManager::SetRun(job.run);
+	SelectScheduler(config.scheduler);
+	
+	RunProbe probe;
+	probe.Start();
+	
+	uint64_t flowBytes = config.maxBytes > 0 ? config.maxBytes : static_cast<uint64_t>(config.nPackets) * ps;
+	
+	//nodes, links with the values given in assignment, addresses and routes
+	DumbbellBuilder builder;
+	ConfigureDumbbell(builder, config);
+	builder.Build();
+	
+	//trace the congestion control state of every local flow, named after its congestion control
+	std::vector<std::string> ccMix = SplitTypeNames(config.ccMix);
+	if(ccMix.empty()) ccMix.push_back("ns3::TcpNewReno");
+	std::unique_ptr<TcpStateTracer> tcpTracer;
+	if(config.tcpTrace)
+	{
+		std::ostringstream traceFileName;
+		traceFileName << "Dumbbell-TcpState-" << ps << "-" << job.run << "-" << GetRank() << ".bin";
+		tcpTracer.reset(new TcpStateTracer(traceFileName.str(), config.tcpTraceBuffer));
+	}
+	
+	//senders of other ranks are learned from the received packets since their tx traces live elsewhere
+	FlowAccounting accounting;
+	accounting.SetLearnFlowsFromSink(GetRankCount() > 1);
+	
+	//the sketch accounting only keeps the flows active at the same time, for very large flow counts
+	std::unique_ptr<SketchAccounting> sketch;
+	if(config.accounting == "sketch")
+	{
+		sketch.reset(new SketchAccounting(config.sketchTopFlows, config.sketchMaxActive, Seconds(config.sketchIdle), config.sketchAccuracy));
+		sketch->Start();
+	}
+	ApplicationContainer sinkApps = builder.InstallSinks(config.sinkPort, Seconds(config.sinkStart), Seconds(config.appStop));
+	for(uint32_t i = 0 ; i < sinkApps.GetN() ; i++)
+	{
+		if(sketch) sketch->AddSink(sinkApps.Get(i));
+		else accounting.AddSink(sinkApps.Get(i));
+	}
+	
+	ApplicationContainer sourceApps = builder.InstallSources([&](Ptr<Socket> socket, const Address& sink, uint32_t flow)
+	{
+		Ptr<MyApp> app = CreateObject<MyApp> ();
+		app->Setup (socket, sink, ps, flowBytes, DataRate (config.appRate), config.bulkSend);
+		app->SetPacketReuse (config.reusePacket);
+		if(tcpTracer) tcpTracer->AddSocket(socket, "flow" + std::to_string(flow) + "-" + ccMix[flow % ccMix.size()]);
+		return Ptr<Application> (app);
+	}, Seconds(config.appStart), Seconds(config.appStop));
+	if(GetRankCount() == 1)
+	{
+		for(uint32_t i = 0 ; i < sourceApps.GetN() ; i++)
+		{
+			if(sketch) sketch->AddSource(sourceApps.Get(i), ccMix[i % ccMix.size()]);
+			else accounting.AddSource(sourceApps.Get(i), ccMix[i % ccMix.size()]);
+		}
+	}
+	
+	//delay and jitter histograms per congestion control, and per flow for up to 64 flows; the
+	//timestamps are put on by the sources, so the sources have to run in this process
+	std::unique_ptr<LatencyTracker> latency;
+	if(config.latency && GetRankCount() == 1)
+	{
+		latency.reset(new LatencyTracker(sourceApps.GetN() <= 64));
+		for(uint32_t i = 0 ; i < sourceApps.GetN() ; i++)
+		{
+			latency->AddSource(sourceApps.Get(i), ccMix[i % ccMix.size()]);
+		}
+		for(uint32_t i = 0 ; i < sinkApps.GetN() ; i++)
+		{
+			latency->AddSink(sinkApps.Get(i));
+		}
+	}
+	
+	//queue of the bottleneck, only available on the rank simulating r1
+	std::unique_ptr<QueueMonitor> queueMonitor;
+	if(config.queueMonitor && builder.IsLocal(builder.GetLeftRouter()))
+	{
+		queueMonitor.reset(new QueueMonitor(config.queueBytes, 32, GetQueueDrainTime(config), 40));
+		queueMonitor->Install(DynamicCast<PointToPointNetDevice>(builder.GetBottleneckDevice(0)));
+	}
+	
+	Simulator::Stop(Seconds(config.simStop));
+	probe.BeginRun();
+	Simulator::Run();
+	probe.EndRun();
+	if(tcpTracer) tcpTracer->Finish();
+	
+	SweepPointResult result;
+	result.packetSize = ps;
+	result.run = job.run;
+	if(sketch) sketch->FillResult(result);
+	else accounting.FillResult(result);
+	probe.AddMetrics(result.metrics);
+	if(queueMonitor) queueMonitor->AddMetrics(result.metrics);
+	if(latency) latency->AddMetrics(result.metrics);
+	result.metrics["senders"] = config.senders;
+	result.metrics["ranks"] = GetRankCount();
+	result.ok = true;
+	
+	Simulator::Destroy();
+	return result;
+}
+
+//run the flow completion time workload over the dumbbell of the configuration: flows arrive as a
+//Poisson process between random senders and receivers, with sizes drawn from config.fctCdf and
+//an arrival rate giving config.fctLoad of the 10Mbps bottleneck. The packet size of the job is
+//the tcp segment size and the senders use the congestion control mix round robin. The average
+//throughput is the goodput of the completed flows; fairness is not defined for the workload.
+SweepPointResult SimulateFctWorkload(const SweepJob& job, const WiredConfig& config)
+{
+	uint32_t ps = job.packetSize;
+	RngSeedManager::SetRun(job.run);
+	SelectScheduler(config.scheduler);
+	
+	RunProbe probe;
+	probe.Start();
+	
+	DumbbellBuilder builder;
+	ConfigureDumbbell(builder, config);
+	builder.Build();
+	
+	FlowSizeCdf cdf;
+	if(!config.fctCdf.empty()) cdf.Load(config.fctCdf);
+	FctWorkload workload;
+	workload.SetCdf(cdf);
+	workload.SetArrivalRate(config.fctLoad * DataRate(config.bottleneckRate).GetBitRate() / (8 * cdf.GetMean()));
+	workload.SetSegmentSize(ps);
+	workload.SetTimeWait(Seconds(config.fctTimeWait));
+	std::vector<std::string> ccMix = SplitTypeNames(config.ccMix);
+	for(uint32_t i = 0 ; i < builder.GetSenders().GetN() ; i++)
+	{
+		Ptr<Node> sender = builder.GetSenders().Get(i);
+		if(!ccMix.empty()) sender->GetObject<TcpL4Protocol>()->SetAttribute("SocketType", TypeIdValue(TypeId::LookupByName(ccMix[i % ccMix.size()])));
+		workload.AddSender(sender);
+	}
+	for(uint32_t i = 0 ; i < builder.GetReceivers().GetN() ; i++)
+	{
+		workload.AddReceiver(builder.GetReceivers().Get(i), builder.GetReceiverAddress(i));
+	}
+	workload.AssignStreams(0);
+	workload.Install(config.sinkPort, Seconds(config.appStart), Seconds(config.appStart + config.fctDuration));
+	
+	std::unique_ptr<QueueMonitor> queueMonitor;
+	if(config.queueMonitor)
+	{
+		queueMonitor.reset(new QueueMonitor(config.queueBytes, 32, GetQueueDrainTime(config), 40));
+		queueMonitor->Install(DynamicCast<PointToPointNetDevice>(builder.GetBottleneckDevice(0)));
+	}
+	
+	Simulator::Stop(Seconds(config.appStart + config.fctDuration + config.fctDrain));
+	probe.BeginRun();
+	Simulator::Run();
+	probe.EndRun();
+	
+	SweepPointResult result;
+	result.packetSize = ps;
+	result.run = job.run;
+	result.avgThroughput = workload.GetCompletedBytes() * 8 / 1024.0 / (config.fctDuration + config.fctDrain);
+	result.fairness = 0;
+	workload.AddMetrics(result.metrics);
+	probe.AddMetrics(result.metrics);
+	if(queueMonitor) queueMonitor->AddMetrics(result.metrics);
+	result.metrics["senders"] = config.senders;
+	result.ok = true;
+	
+	Simulator::Destroy();
+	return result;
+}
+
+//simulate one sweep point of the topology or workload selected by the configuration
+SweepPointResult SimulateSweepPoint(const SweepJob& job, const WiredConfig& config)
+{
+	if(config.fct) return SimulateFctWorkload(job, config);
+	return config.dumbbell ? SimulateDumbbell(job, config) : SimulateWired(job, config);
+}
+
+//key of everything the result of a sweep point depends on, including the links and applications
+//of the configuration the simulations are built from. The scheduler and the packet reuse do not
+//change the results and are left out, so their benchmarks can share entries.
+ResultKey GetSweepPointKey(const SweepJob& job, const WiredConfig& config)
+{
+	ResultKey key;
+	key.Add("program", "wired");
+	key.Add("accessRate", config.accessRate).Add("accessDelay", config.accessDelay);
+	key.Add("bottleneckRate", config.bottleneckRate).Add("bottleneckDelay", config.bottleneckDelay).Add("queueBytes", config.queueBytes);
+	key.Add("sinkPort", config.sinkPort).Add("appStart", config.appStart);
+	if(config.fct)
+	{
+		key.Add("topology", "fct");
+		key.Add("senders", config.senders).Add("receivers", config.receivers).Add("ccMix", config.ccMix);
+		if(config.fctCdf.empty()) key.Add("fctCdf", "websearch");
+		else key.AddFile("fctCdf", config.fctCdf);
+		key.Add("fctLoad", config.fctLoad).Add("fctDuration", config.fctDuration).Add("fctDrain", config.fctDrain);
+		key.Add("fctTimeWait", config.fctTimeWait);
+	}
+	else if(config.dumbbell)
+	{
+		key.Add("topology", "dumbbell");
+		key.Add("appRate", config.appRate).Add("sinkStart", config.sinkStart).Add("appStop", config.appStop).Add("simStop", config.simStop);
+		key.Add("senders", config.senders).Add("receivers", config.receivers).Add("flowsPerSender", config.flowsPerSender);
+		key.Add("ccMix", config.ccMix);
+	}
+	else
+	{
+		key.Add("topology", "wired");
+		key.Add("appRate", config.appRate).Add("sinkStart", config.sinkStart).Add("appStop", config.appStop).Add("simStop", config.simStop);
+		key.Add("tcpTypes", std::string(WIRED_TCP_TYPES[0]) + "," + WIRED_TCP_TYPES[1] + "," + WIRED_TCP_TYPES[2]);
+	}
+	key.Add("packetSize", job.packetSize).Add("run", job.run).Add("seed", RngSeedManager::GetSeed());
+	key.Add("bulkSend", config.bulkSend).Add("maxBytes", config.maxBytes).Add("nPackets", config.nPackets);
+	key.Add("accounting", config.accounting).Add("sampleInterval", config.sampleInterval);
+	key.Add("steadyState", config.steadyState);
+	if(config.accounting == "sketch")
+	{
+		key.Add("sketchTopFlows", config.sketchTopFlows).Add("sketchMaxActive", config.sketchMaxActive);
+		key.Add("sketchIdle", config.sketchIdle).Add("sketchAccuracy", config.sketchAccuracy);
+	}
+	if(config.steadyState)
+	{
+		key.Add("steadyWindow", config.steadyWindow).Add("steadyHistory", config.steadyHistory);
+		key.Add("steadyTolerance", config.steadyTolerance).Add("warmup", config.warmup);
+	}
+	key.Add("routing", config.routing).Add("queueMonitor", config.queueMonitor).Add("tcpTrace", config.tcpTrace);
+	key.Add("latency", config.latency);
+	if(!config.capture.empty())
+	{
+		key.Add("capture", config.capture).Add("captureOneIn", config.captureOneIn).Add("captureRecords", config.captureRecords);
+		key.Add("captureSnap", config.captureSnap).Add("captureDropBurst", config.captureDropBurst).Add("captureCollapse", config.captureCollapse);
+	}
+	if(config.anim)
+	{
+		key.Add("anim", config.anim).Add("animEvery", config.animEvery).Add("animWindows", config.animWindows).Add("animCompress", config.animCompress);
+	}
+	return key;
+}
+
+//whether the sweep points write files besides their results (tcp state trace, samples, capture
+//and animation), which a point taken from the result cache does not write again
+bool WritesPointFiles(const WiredConfig& config)
+{
+	return config.tcpTrace || config.sampleInterval > 0 || !config.capture.empty() || config.anim;
+}
+
+//print the per-flow statistics of one sweep point
+void PrintSweepPoint(const SweepPointResult& result)
+{
+	if(result.flows.empty()) std::cout << "No flow";
+	std::cout << "Packet-Size : " << result.packetSize << "\n\n";
+	
+	for(const FlowResult& flow : result.flows)
+	{
+		uint32_t flowID = flow.flowId;
+		if(flowID == 1 || flowID == 2 || flowID == 3) std::cout << "n0 ---> n1\n";
+		else std::cout << "n1 ---> n0\n";
+		if(!flow.type.empty()) std::cout << "TCP Flow Type : " << flow.type << "\n";
+		std::cout << "Throughput : " << flow.throughput << " Kbps\n"; 
+		std::cout << "Recevied Bytes : " << flow.rxBytes << "\n"; 
+		std::cout << "Time : " << flow.lastRx - flow.firstTx << " s\n";
+		std::map<std::string, double>::const_iterator delay = result.metrics.find("flowmonDelayMeanMs." + std::to_string(flowID));
+		std::map<std::string, double>::const_iterator jitter = result.metrics.find("flowmonJitterMeanMs." + std::to_string(flowID));
+		if(delay != result.metrics.end()) std::cout << "Mean Delay : " << delay->second << " ms\n";
+		if(jitter != result.metrics.end()) std::cout << "Mean Jitter : " << jitter->second << " ms\n";
+		std::cout << "\n";
+	}
+	
+	std :: cout << "Average Throughput: " << result.avgThroughput << " Kbps\n";
+	std :: cout << "FairnessIndex: " << result.fairness << "\n";
+	
+	//report when and why the simulation stopped if the convergence monitor was used
+	std::map<std::string, double>::const_iterator stopReason = result.metrics.find("stopReason");
+	if(stopReason != result.metrics.end())
+	{
+		std :: cout << "Stopped at : " << result.metrics.at("stopTime") << " s (" << SteadyStateMonitor::GetStopReasonName(stopReason->second) << ")\n";
+		std :: cout << "Steady-State Average Throughput: " << result.metrics.at("steadyAvgThroughput") << " Kbps\n";
+		std :: cout << "Steady-State FairnessIndex: " << result.metrics.at("steadyFairness") << "\n";
+	}
+	
+	//bottleneck queue histograms and drops if the queue monitor was used
+	PrintQueueMetrics(std::cout, result.metrics);
+	
+	//completion time percentiles per flow size if the fct workload was run
+	PrintFctMetrics(std::cout, result.metrics);
+	
+	//flow counts and delay quantiles if the sketch accounting was used
+	PrintSketchMetrics(std::cout, result.metrics);
+	
+	//delay and jitter percentiles per congestion control and flow if they were recorded
+	PrintLatencyMetrics(std::cout, result.metrics);
+    		    
+	std :: cout << "---------------------------------------------------------\n\n";
+}
+
+//convert a binary tcp state trace to csv, written next to it with a .csv extension
+void ConvertTcpTrace(const std::string& fileName)
+{
+	std::string csvName = fileName.substr(0, fileName.rfind('.')) + ".csv";
+	uint64_t samples = ConvertTcpStateTrace(fileName, csvName);
+	std::cout << "Converted " << samples << " sample(s) to " << csvName << std::endl;
+}
+
+//microbenchmark comparing heap allocations per simulated second with and without packet reuse,
+//needs the "allocations" metric of a build with -DCOUNT_ALLOCATIONS
+void RunAllocationBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WiredConfig config)
+{
+	config.reusePacket = false;
+	std::vector<SweepPointResult> created = RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWired(job, config); });
+	config.reusePacket = true;
+	std::vector<SweepPointResult> reused = RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWired(job, config); });
+	
+	std::cout << "Packet-Size\tAllocs/sim-s (Create)\tAllocs/sim-s (Reuse)\tReduction" << std::endl;
+	for(size_t i = 0 ; i < packetSizes.size() ; i++)
+	{
+		if(!created[i].ok || !reused[i].ok) continue;
+		double before = created[i].metrics["allocations"] / created[i].metrics["simSeconds"];
+		double after = reused[i].metrics["allocations"] / reused[i].metrics["simSeconds"];
+		std::cout << packetSizes[i] << "\t\t" << before << "\t\t\t" << after << "\t\t\t"
+		          << (before > 0 ? 100.0 * (before - after) / before : 0.0) << " %" << std::endl;
+	}
+}
+
+//benchmark of building the dumbbell (nodes, links, addresses, routes and applications) for
+//10, 100, 1000, ... flows up to maxFlows, without running the simulation
+void RunBuildBenchmark(uint32_t packetSize, uint32_t maxFlows, WiredConfig config)
+{
+	std::cout << "Flows\tSenders\tNodes\tBuild(s)\tBuild/flow(us)\tRSS growth(KB)\tRSS/flow(KB)\tPeak RSS(KB)" << std::endl;
+	uint32_t flowsPerSender = config.flowsPerSender < 1 ? 1 : config.flowsPerSender;
+	for(uint32_t flows = 10 ; flows <= maxFlows ; flows *= 10)
+	{
+		config.flowsPerSender = flowsPerSender;
+		config.senders = (flows + flowsPerSender - 1) / flowsPerSender;
+		
+		ResetPeakRss();
+		double rssStart = GetCurrentRssKb();
+		auto start = std::chrono::steady_clock::now();
+		DumbbellBuilder builder;
+		ConfigureDumbbell(builder, config);
+		builder.Build();
+		builder.InstallSinks(config.sinkPort, Seconds(config.sinkStart), Seconds(config.appStop));
+		builder.InstallSources([&](Ptr<Socket> socket, const Address& sink, uint32_t flow)
+		{
+			Ptr<MyApp> app = CreateObject<MyApp> ();
+			app->Setup (socket, sink, packetSize, 0, DataRate (config.appRate), config.bulkSend);
+			return Ptr<Application> (app);
+		}, Seconds(config.appStart), Seconds(config.appStop));
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		double rssGrowth = GetCurrentRssKb() - rssStart;
+		uint32_t nFlows = builder.GetFlowCount();
+		
+		std::cout << nFlows << "\t" << config.senders << "\t" << NodeList::GetNNodes() << "\t" << seconds << "\t\t"
+		          << seconds * 1e6 / nFlows << "\t\t" << rssGrowth << "\t\t" << rssGrowth / nFlows << "\t\t"
+		          << GetPeakRssKb() << std::endl;
+		Simulator::Destroy();
+	}
+}
+
+//benchmark of the routing setup of the dumbbell with 1, 10, 100, ... up to maxSenders sender hosts.
+//Nix-vector routing computes its paths when the first packet goes to a destination, so the
+//time to run until every flow has sent its SYN (1.5s) is reported as well.
+void RunRoutingBenchmark(uint32_t packetSize, uint32_t maxSenders, WiredConfig config)
+{
+	const char* modes[3] = {"global", "nix", "static"};
+	std::cout << "Senders\tNodes\tRouting\tSetup(s)\tFirst packets(s)\tRSS growth(KB)" << std::endl;
+	for(uint32_t senders = 1 ; senders <= maxSenders ; senders *= 10)
+	{
+		for(uint32_t m = 0 ; m < 3 ; m++)
+		{
+			config.senders = senders;
+			config.routing = modes[m];
+			
+			double rssStart = GetCurrentRssKb();
+			auto start = std::chrono::steady_clock::now();
+			DumbbellBuilder builder;
+			ConfigureDumbbell(builder, config);
+			builder.Build();
+			double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			
+			builder.InstallSinks(config.sinkPort, Seconds(config.sinkStart), Seconds(config.appStop));
+			builder.InstallSources([&](Ptr<Socket> socket, const Address& sink, uint32_t flow)
+			{
+				Ptr<MyApp> app = CreateObject<MyApp> ();
+				app->Setup (socket, sink, packetSize, 0, DataRate (config.appRate), config.bulkSend);
+				return Ptr<Application> (app);
+			}, Seconds(config.appStart), Seconds(config.appStop));
+			start = std::chrono::steady_clock::now();
+			Simulator::Stop(Seconds(1.5));
+			Simulator::Run();
+			double firstPackets = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			
+			std::cout << senders << "\t" << NodeList::GetNNodes() << "\t" << modes[m] << "\t" << setup << "\t\t"
+			          << firstPackets << "\t\t\t" << GetCurrentRssKb() - rssStart << std::endl;
+			Simulator::Destroy();
+		}
+	}
+}
+
+//scaling benchmark of the (distributed) dumbbell as the number of sender hosts grows
+void RunDumbbellScaling(uint32_t packetSize, uint32_t maxSenders, WiredConfig config)
+{
+	if(GetRank() == 0)
+	{
+		std::cout << "Ranks : " << GetRankCount() << std::endl;
+		std::cout << "Senders\tFlows\tWall(s)\tEvents(rank 0)\tEvents/s\tSim-s/Wall-s\tAverage Throughput(Kbps)" << std::endl;
+	}
+	for(uint32_t senders = 1 ; senders <= maxSenders ; senders *= 10)
+	{
+		config.senders = senders;
+		SweepPointResult result = SimulateDumbbell({packetSize, 1}, config);
+		if(GetRank() != 0) continue;
+		double wall = result.metrics["wallSeconds"];
+		std::cout << senders << "\t" << result.flows.size() << "\t" << wall << "\t"
+		          << result.metrics["events"] << "\t\t" << result.metrics["eventsPerSecond"] << "\t"
+		          << (wall > 0 ? result.metrics["simSeconds"] / wall : 0.0) << "\t\t" << result.avgThroughput << std::endl;
+	}
+}
+
+//benchmark comparing the run cost of FlowMonitor and the trace based flow accounting
+void RunAccountingBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WiredConfig config)
+{
+	std::vector<std::string> names = {"flowmon", "trace", "sketch"};
+	std::vector<std::vector<SweepPointResult> > sweeps;
+	for(const std::string& name : names)
+	{
+		config.accounting = name;
+		sweeps.push_back(RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWired(job, config); }));
+	}
+	PrintRunComparison(std::cout, names, sweeps);
+}
+
+//events/sec of every event scheduler at every packet size
+void RunSchedulerBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WiredConfig config)
+{
+	std::vector<std::string> names = GetSchedulerNames();
+	std::vector<std::vector<SweepPointResult> > sweeps;
+	for(const std::string& name : names)
+	{
+		config.scheduler = name;
+		sweeps.push_back(RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateSweepPoint(job, config); }));
+	}
+	PrintRunComparison(std::cout, names, sweeps);
+}
 
 int main(int argc, char* argv[])
 {   
 
+	//number of sweep points simulated in parallel, 0 uses one worker per cpu core
+	uint32_t workers = 0;
+	
+	//options shared by all sweep points
+	WiredConfig config;
+	
+	//number of replications of every packet size and the relative confidence interval width aimed for
+	uint32_t runs = 1;
+	double ciTarget = 0.05;
+	
+	//run the allocation microbenchmark instead of the normal sweep
+	bool allocBench = false;
+	
+	//run the flow accounting benchmark instead of the normal sweep
+	bool accountingBench = false;
+	
+	//run the dumbbell scaling benchmark up to this many sender hosts (0 = normal sweep)
+	uint32_t scalingBench = 0;
+	
+	//run the dumbbell build benchmark up to this many flows (0 = normal sweep)
+	uint32_t buildBench = 0;
+	
+	//run the routing setup benchmark up to this many sender hosts (0 = normal sweep)
+	uint32_t routingBench = 0;
+	
+	//run the scheduler benchmark instead of the normal sweep
+	bool schedulerBench = false;
+	
+	//benchmark report written after the sweep, baseline report it is compared with and the
+	//relative slowdown accepted before a sweep point counts as a regression
+	std::string benchReport = "";
+	std::string baseline = "";
+	double regressionThreshold = 0.1;
+	
+	//where the per-flow and per-sweep-point results go: console, or a csv/jsonl file named after outputFile
+	std::string output = "console";
+	std::string outputFile = "Wired-Results";
+	
+	//refine the packet sizes adaptively instead of simulating the fixed ones
+	bool adaptive = false;
+	AdaptiveSweepOptions adaptiveOptions;
+	
+	//directory of the result cache (empty = always simulate) and whether only cached points are used
+	std::string cacheDir = "";
+	bool cacheOnly = false;
+	
+	//binary tcp state trace to convert to csv instead of running the sweep
+	std::string convertTcpTrace = "";
+	
+	CommandLine cmd(__FILE__);
+	cmd.AddValue("workers", "Number of worker processes used for the packet size sweep (0 = one per core, 1 = sequential)", workers);
+	cmd.AddValue("runs", "Number of replications of every packet size with different rng run numbers", runs);
+	cmd.AddValue("ciTarget", "Relative 95% confidence interval width used to estimate the needed replications", ciTarget);
+	cmd.AddValue("bulkSend", "Fill the socket tx buffer and wait for space instead of scheduling one event per packet", config.bulkSend);
+	cmd.AddValue("maxBytes", "Bytes sent by every flow (0 = nPackets packets of the current packet size)", config.maxBytes);
+	cmd.AddValue("nPackets", "Packets sent by every flow when maxBytes is 0 (0 = send until the application stops)", config.nPackets);
+	cmd.AddValue("packetReuse", "Send copies of one prototype packet instead of allocating a packet per send", config.reusePacket);
+	cmd.AddValue("allocBench", "Only run the packet allocation microbenchmark (with and without packetReuse), needs a build with -DCOUNT_ALLOCATIONS", allocBench);
+	cmd.AddValue("accounting", "Flow statistics collection: flowmon (FlowMonitor on all nodes), trace (application traces only) or sketch (bounded memory, top flows and delay quantiles)", config.accounting);
+	cmd.AddValue("sampleInterval", "Interval in seconds of the streamed throughput/fairness time series (0 = disabled)", config.sampleInterval);
+	cmd.AddValue("steadyState", "Stop every sweep point early once the flow throughputs have converged", config.steadyState);
+	cmd.AddValue("steadyWindow", "Throughput window of the convergence monitor in seconds", config.steadyWindow);
+	cmd.AddValue("steadyHistory", "Number of windows compared by the convergence monitor", config.steadyHistory);
+	cmd.AddValue("steadyTolerance", "Relative change of the windowed mean and deviation accepted as converged", config.steadyTolerance);
+	cmd.AddValue("warmup", "Time in seconds before which throughput windows are discarded", config.warmup);
+	cmd.AddValue("capture", "Sample headers of the r1-r2 devices into a ring dumped to pcap on a drop burst, cwnd collapse or at the end: packets or flows (empty = off)", config.capture);
+	cmd.AddValue("captureOneIn", "Capture one in this many packets (capture=packets) or flows (capture=flows)", config.captureOneIn);
+	cmd.AddValue("captureRecords", "Packets held by the preallocated capture ring", config.captureRecords);
+	cmd.AddValue("captureSnap", "Bytes kept of every captured packet", config.captureSnap);
+	cmd.AddValue("captureDropBurst", "Drops within 100ms that dump the capture ring (0 = no drop trigger)", config.captureDropBurst);
+	cmd.AddValue("captureCollapse", "Dump the capture ring when a cwnd falls below this fraction of its previous value (0 = no cwnd trigger)", config.captureCollapse);
+	cmd.AddValue("anim", "Write a NetAnim trace of every sweep point holding only the packets chosen by animEvery and animWindows", config.anim);
+	cmd.AddValue("animEvery", "Animate every this many packets sent over the links (1 = all)", config.animEvery);
+	cmd.AddValue("animWindows", "Only animate the packets sent within these start-stop windows in seconds, e.g. 10-10.5,12-13 (empty = whole run)", config.animWindows);
+	cmd.AddValue("animCompress", "Pipe the animation through gzip into a .xml.gz file", config.animCompress);
+	cmd.AddValue("animBuffer", "Bytes of animation xml buffered before they are written out", config.animBuffer);
+	cmd.AddValue("latency", "Record one-way delay and jitter percentiles of every flow and congestion control and plot them against the packet size", config.latency);
+	cmd.AddValue("sketchTopFlows", "Flows with the most received bytes listed with exact counters by accounting=sketch", config.sketchTopFlows);
+	cmd.AddValue("sketchMaxActive", "Flows tracked at the same time by accounting=sketch before the least recently active one is folded", config.sketchMaxActive);
+	cmd.AddValue("sketchIdle", "Time in seconds without packets after which accounting=sketch folds a flow into the aggregates, 0 only folds flows beyond sketchMaxActive", config.sketchIdle);
+	cmd.AddValue("sketchAccuracy", "Relative error of the delay and jitter quantiles of accounting=sketch", config.sketchAccuracy);
+	cmd.AddValue("accountingBench", "Only run the benchmark comparing FlowMonitor, trace based and sketch accounting", accountingBench);
+	cmd.AddValue("dumbbell", "Simulate the multi-sender dumbbell, split at the r1-r2 link over 2 mpi ranks when run with mpirun -np 2", config.dumbbell);
+	cmd.AddValue("senders", "Number of sender hosts of the dumbbell", config.senders);
+	cmd.AddValue("receivers", "Number of receiver hosts of the dumbbell, flows are spread over them round robin", config.receivers);
+	cmd.AddValue("flowsPerSender", "Number of flows started by every sender host of the dumbbell", config.flowsPerSender);
+	cmd.AddValue("ccMix", "Comma separated congestion control types assigned to the dumbbell flows round robin", config.ccMix);
+	cmd.AddValue("routing", "Routing of the topology: global, nix (Nix-vector) or static (generated default routes)", config.routing);
+	cmd.AddValue("routingBench", "Only run the routing setup benchmark with 1, 10, 100, ... up to this many dumbbell senders", routingBench);
+	cmd.AddValue("buildBench", "Only run the dumbbell build time and memory benchmark with 10, 100, ... up to this many flows", buildBench);
+	cmd.AddValue("scalingBench", "Only run the dumbbell scaling benchmark with 1, 10, 100, ... up to this many senders", scalingBench);
+	cmd.AddValue("scheduler", "Event scheduler: map (default), heap, calendar, list or priority", config.scheduler);
+	cmd.AddValue("schedulerBench", "Only run the benchmark of the events/sec of every scheduler at every packet size", schedulerBench);
+	cmd.AddValue("output", "Result output: console, csv (<outputFile>.meta/points/flows.csv) or jsonl (<outputFile>.jsonl)", output);
+	cmd.AddValue("outputFile", "Prefix of the result files written with output csv or jsonl", outputFile);
+	cmd.AddValue("cacheDir", "Directory of the result cache, sweep points with a cached result are not simulated again", cacheDir);
+	cmd.AddValue("cacheOnly", "Only use the cached sweep points and rebuild the output and plots from them without simulating", cacheOnly);
+	cmd.AddValue("adaptive", "Start from a coarse packet size grid and add sizes where throughput or fairness change sharply or vary between runs", adaptive);
+	cmd.AddValue("adaptiveBudget", "Number of simulations (packet sizes times runs) the adaptive sweep may use", adaptiveOptions.budget);
+	cmd.AddValue("adaptiveCoarse", "Number of log spaced packet sizes of the initial adaptive grid", adaptiveOptions.coarsePoints);
+	cmd.AddValue("adaptiveThreshold", "Relative change or confidence interval width above which an interval is split", adaptiveOptions.threshold);
+	cmd.AddValue("adaptiveMinGap", "Packet size intervals narrower than this many bytes are not split", adaptiveOptions.minGap);
+	cmd.AddValue("minPacketSize", "Smallest packet size of the adaptive sweep", adaptiveOptions.minPacketSize);
+	cmd.AddValue("maxPacketSize", "Largest packet size of the adaptive sweep", adaptiveOptions.maxPacketSize);
+	cmd.AddValue("queueMonitor", "Record occupancy and sojourn time histograms and per-flow drops of the bottleneck queue", config.queueMonitor);
+	cmd.AddValue("tcpTrace", "Record cwnd, rtt, ssthresh and congestion state of every flow to <program>-TcpState-<size>-<run>.bin", config.tcpTrace);
+	cmd.AddValue("tcpTraceBuffer", "Samples buffered per flow before the tcp state trace is written out", config.tcpTraceBuffer);
+	cmd.AddValue("convertTcpTrace", "Only convert this binary tcp state trace to csv", convertTcpTrace);
+	cmd.AddValue("fct", "Run the flow completion time workload (Poisson arrivals, heavy tailed sizes) on the dumbbell senders and receivers", config.fct);
+	cmd.AddValue("fctCdf", "Flow size cdf file of \"bytes probability\" lines (empty = web search distribution)", config.fctCdf);
+	cmd.AddValue("fctLoad", "Offered load of the flow completion time workload as a fraction of the bottleneck rate", config.fctLoad);
+	cmd.AddValue("fctDuration", "Time in seconds during which workload flows arrive", config.fctDuration);
+	cmd.AddValue("fctDrain", "Time in seconds after the last arrival given to the workload flows to complete", config.fctDrain);
+	cmd.AddValue("fctTimeWait", "TIME_WAIT in seconds of the closed workload sockets before they are released", config.fctTimeWait);
+	cmd.AddValue("benchReport", "Write the wall time, events, events/sec, sim/wall seconds, packets, nodes and peak RSS of every sweep point to this json lines file", benchReport);
+	cmd.AddValue("baseline", "Compare the run cost of the sweep with this benchmark report and exit with 1 on a regression", baseline);
+	cmd.AddValue("regressionThreshold", "Relative growth of wall time or peak RSS (or drop of events/sec) reported as a regression", regressionThreshold);
+	cmd.Parse(argc, argv);
+	
+#ifdef NS3_MPI
+	//use the distributed simulator for the dumbbell, all ranks simulate the same points in lockstep;
+	//the fct workload keeps the state of its flows in one process and always runs sequentially
+	if((config.dumbbell || scalingBench > 0) && !config.fct)
+	{
+		GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+		MpiInterface::Enable(&argc, &argv);
+		workers = 1;
+	}
+#endif
+	
 	//set time unit as nanoseconds
 	Time::SetResolution(Time::NS);
     
-	//enable logs for the given classes
+	//logs of the given classes run in the hot path and flush the console for every line, they are
+	//only compiled in when built with -DENABLE_HOT_PATH_LOGGING
+#ifdef ENABLE_HOT_PATH_LOGGING
 	LogComponentEnable("TcpSocket", LOG_LEVEL_INFO);
 	LogComponentEnable("PointToPointHelper", LOG_LEVEL_INFO);
+#endif
     
 	//declare variables for plotting throughput and fairness
 	std::string graphicsFileName1, graphicsFileNameFairness;
@@ -195,218 +1494,164 @@ int main(int argc, char* argv[])
    
 	//store packet sizes to be used in an array
 	uint32_t packetSize[10] = {40, 44, 48, 52, 60, 552, 576, 628, 1420, 1500};
+	std::vector<uint32_t> packetSizes(packetSize, packetSize + 10);
+	
+	if(!convertTcpTrace.empty())
+	{
+		ConvertTcpTrace(convertTcpTrace);
+		return 0;
+	}
+	if(allocBench)
+	{
+#ifdef COUNT_ALLOCATIONS
+		RunAllocationBenchmark(packetSizes, workers, config);
+		return 0;
+#else
+		std::cerr << "The allocation benchmark needs a build with -DCOUNT_ALLOCATIONS" << std::endl;
+		return 1;
+#endif
+	}
+	if(accountingBench)
+	{
+		RunAccountingBenchmark(packetSizes, workers, config);
+		return 0;
+	}
+	if(schedulerBench)
+	{
+		RunSchedulerBenchmark(packetSizes, workers, config);
+		FinishMpi();
+		return 0;
+	}
+	if(routingBench > 0)
+	{
+		RunRoutingBenchmark(packetSizes.back(), routingBench, config);
+		return 0;
+	}
+	if(buildBench > 0)
+	{
+		RunBuildBenchmark(packetSizes.back(), buildBench, config);
+		return 0;
+	}
+	if(scalingBench > 0)
+	{
+		RunDumbbellScaling(packetSizes.back(), scalingBench, config);
+		FinishMpi();
+		return 0;
+	}
+	
 	std :: cout << "---------------------------------------------------------" << std::endl<< std::endl;
 	
-	//for each packet size
-	for(int j = 0 ; j < 10 ; j++)
-	{		     
-		//create the 4 nodes needed along with containers
-		NodeContainer n2;
-		n2.Create(1);
-    
-		NodeContainer n3;
-		n3.Create(1);
-    
-		NodeContainer r1;
-		r1.Create(1);
-    
-		NodeContainer r2;
-		r2.Create(1);
-    
-		//add r1 node to n2 container
-		n2.Add(r1);
-    
-		//declare helper for creating point-to-point link and set data rate and delay values given in assignment
-		PointToPointHelper pointToPoint1;
-		pointToPoint1.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-		pointToPoint1.SetChannelAttribute("Delay", StringValue("20ms"));
- 
-		//install the devices n2 and r1 as end points of the point-to-point channel
-		NetDeviceContainer n2r1;
-		n2r1 = pointToPoint1.Install(n2);
-    
-		//add r2 node to r1 container
-		r1.Add(r2);
-    
-		//declare helper for creating point-to-point link and set data rate and delay values given in assignment
-		PointToPointHelper pointToPoint2;
-		pointToPoint2.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
-		pointToPoint2.SetChannelAttribute("Delay", StringValue("50ms"));
- 
-		//set droptail queue with size as bandwidth-delay product
-		pointToPoint2.SetQueue ("ns3::DropTailQueue", "MaxSize", QueueSizeValue(QueueSize(QueueSizeUnit::BYTES, 6250)));
-    
-		//install the devices r1 and r2 as end points of the point-to-point channel
-		NetDeviceContainer r1r2;
-		r1r2 = pointToPoint2.Install(r1);
-    
-		//add n3 node to r2 container
-		r2.Add(n3);
-    
-		//declare helper for creating point-to-point link and set data rate and delay values given in assignment
-		PointToPointHelper pointToPoint3;
-		pointToPoint3.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-		pointToPoint3.SetChannelAttribute("Delay", StringValue("20ms"));
-    
-		//install the devices r2 and n3 as end points of the point-to-point channel
-		NetDeviceContainer r2n3;
-		r2n3 = pointToPoint3.Install(r2);
-    
-		//add r2 node to n2 container
-		//this fills n2 container with all 4 nodes n2,r1,r2,n3
-		n2.Add(r2);
-    
-		//install internet stack on all nodes
-		InternetStackHelper stack;
-		stack.Install(n2);
-   
-		//assign ipv4 addresses to all devices
-		Ipv4AddressHelper address;
-
-		address.SetBase("10.1.1.0", "255.255.255.0");
-
-		Ipv4InterfaceContainer n2r1Interfaces = address.Assign(n2r1);
-    
-		address.SetBase("10.1.2.0", "255.255.255.0");
-
-		Ipv4InterfaceContainer r1r2Interfaces = address.Assign(r1r2);
-    
-		address.SetBase("10.1.3.0", "255.255.255.0");
-
-		Ipv4InterfaceContainer r2n3Interfaces = address.Assign(r2n3);
-
-		//use global routing and create routing tables
-		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-    
-		//ps stores current packet size
-		uint32_t ps = packetSize[j];
-		    	
-		//set tcp congestion control algorithm as Westwood for source node n2	    	
-		TypeId tid = TypeId::LookupByName("ns3::TcpWestwood");
-		std::stringstream nodeId;
-		nodeId << n2.Get(0)->GetId();
-		std::string specificNode = "/NodeList/" + nodeId.str() + "/$ns3::TcpL4Protocol/SocketType";
-		Config::Set(specificNode, TypeIdValue(tid));
+	//simulate every packet size and replication, each one in its own worker process
+	//points found in the result cache are not simulated again, a distributed run always simulates
+	//since every rank has to take part in every point
+	SweepFunction simulate = [&config](const SweepJob& job) { return SimulateSweepPoint(job, config); };
+	if(!cacheDir.empty() && WritesPointFiles(config))
+	{
+		if(cacheOnly)
+		{
+			std :: cout << "Result cache : the per-point files of cached points are not written again\n";
+		}
+		else
+		{
+			std :: cout << "Result cache : not used, the sweep points write per-point files\n";
+			cacheDir = "";
+		}
+	}
+	std::unique_ptr<ResultCache> cache;
+	if(!cacheDir.empty() && GetRankCount() == 1)
+	{
+		cache.reset(new ResultCache(cacheDir));
+	}
+	SweepBatchFunction simulateBatch = [&](const std::vector<SweepJob>& jobs)
+	{
+		if(cache) return RunCachedSweep(jobs, workers, simulate, *cache, [&config](const SweepJob& job) { return GetSweepPointKey(job, config); }, cacheOnly);
+		return RunSweep(jobs, workers, simulate);
+	};
 
-		//use sink port as 8080	    
-		uint16_t sinkPort = 8080;
-		    
-		//create socket and tcp sink application and install it on node n3
-		Address sinkAddress (InetSocketAddress(r2n3Interfaces.GetAddress (1), sinkPort));
-		PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
-		ApplicationContainer sinkApps = packetSinkHelper.Install (n3.Get (0));
-		sinkApps.Start (Seconds (0.));
-		sinkApps.Stop (Seconds (10.));
-		    
-		  
-		//create socket for tcp source node n2 with congestion control algorithm as Westwood
-		Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (n2.Get (0), TcpSocketFactory::GetTypeId ());
-		    
-		//create and install tcp source application with congestion control algorithm as Westwood on node n2 using our custom made application class "MyApp"
-		Ptr<MyApp> app = CreateObject<MyApp> ();
-		app->Setup (ns3TcpSocket, sinkAddress, ps, 100, DataRate ("100Mbps"));
-		n2.Get (0)->AddApplication (app);
-		app->SetStartTime(Seconds(1.0));
-		app->SetStopTime(Seconds(10.0));
-		    
-		//set tcp congestion control algorithm as Veno for source node n2
-		tid = TypeId::LookupByName("ns3::TcpVeno");
-		Config::Set(specificNode, TypeIdValue(tid));
-		    
-		   
-		//create socket for tcp source node n2 with congestion control algorithm as Veno
-		Ptr<Socket> ns3TcpSocket2 = Socket::CreateSocket (n2.Get (0), TcpSocketFactory::GetTypeId ());
-		    
-		//create and install tcp source application with congestion control algorithm as Veno on node n2 using our custom made application class "MyApp"
-		Ptr<MyApp> app2 = CreateObject<MyApp> ();
-		app2->Setup (ns3TcpSocket2, sinkAddress, ps, 100, DataRate ("100Mbps"));
-		n2.Get (0)->AddApplication (app2);
-		app2->SetStartTime(Seconds(1.0));
-		app2->SetStopTime(Seconds(10.0));
-		    
-		//set tcp congestion control algorithm as Vegas for source node n2
-		tid = TypeId::LookupByName("ns3::TcpVegas");
-		Config::Set(specificNode, TypeIdValue(tid));
-		    
-		//create socket for tcp source node n2 with congestion control algorithm as Vegas
-		Ptr<Socket> ns3TcpSocket3 = Socket::CreateSocket (n2.Get (0), TcpSocketFactory::GetTypeId ());
-		    
-		//create and install tcp source application with congestion control algorithm as Vegas on node n2 using our custom made application class "MyApp" 
-		Ptr<MyApp> app3 = CreateObject<MyApp> ();
-		app3->Setup (ns3TcpSocket3, sinkAddress, ps, 100, DataRate ("100Mbps"));
-		n2.Get (0)->AddApplication (app3);
-		app3->SetStartTime(Seconds(1.0));
-		app3->SetStopTime(Seconds(10.0));
-		       
-		//create flow monitor
-		Ptr<FlowMonitor> flowMonitor;
-		FlowMonitorHelper flowHelper;
-		flowMonitor = flowHelper.InstallAll();
-		    
-		/*
-		Ptr< Node > n2ptr = n2.Get(0);
-		Ptr< Node > n3ptr = n3.Get(0);
-		Ptr< Node > r1ptr = r1.Get(0);
-		Ptr< Node > r2ptr = r2.Get(0);
-		AnimationInterface anim("wired.xml");
-		anim.SetConstantPosition(n2ptr, 0.0, 0.0);
-		anim.SetConstantPosition(r1ptr, 2.0, 0.0);
-		anim.SetConstantPosition(r2ptr, 4.0, 0.0);
-		anim.SetConstantPosition(n3ptr, 6.0, 0.0);
-		*/
-		Simulator::Stop(Seconds(15.0));
-		    
-    	Simulator::Run();
-    		    
-    	//obtain the flow statistics from flow monitor
-		FlowMonitor :: FlowStatsContainer fsc = flowMonitor->GetFlowStats();
-		if(fsc.empty()) std::cout << "No flow";
-		FlowMonitor :: FlowStatsContainerI it;
-		    
-		//throughput is calculated as (number of bits received by sink) / (time when last packet was received - time when first packet was transmitted)
-		//jain's fairness index = (sum of throughputs)^2 / (number of flows * sum of squares of throughputs)
-		uint32_t flowID;
-		double avg_throughput = 0.0;
-		double throughput_sum = 0.0, throughput_square_sum = 0.0;
-		std::cout << "Packet-Size : " << ps << std::endl<< std::endl;
-		    
-		for(it = fsc.begin() ; it != fsc.end(); it++)
-		{    	   
-			FlowMonitor :: FlowStats fs = it->second;
-			flowID = it->first;
-			   
-			uint64_t recv_bytes = fs.rxBytes;
-			Time t = fs.timeFirstTxPacket;
-			double t1 = t.GetSeconds();
-			t = fs.timeLastRxPacket;
-			double t2 = t.GetSeconds();
-			    
-			double throughput = (recv_bytes * 8.0) / (t2-t1);
-			throughput = throughput / 1024;
-			throughput_sum += throughput;
-			throughput_square_sum += throughput * throughput;
-			if(flowID == 1 || flowID == 2 || flowID == 3) std::cout << "n0 ---> n1" << std::endl;
-			else std::cout << "n1 ---> n0" << std::endl;
-			if(flowID == 1 || flowID == 2) std::cout << "TCP Flow Type : Westwood" << std::endl;
-			if(flowID == 3 || flowID == 4) std::cout << "TCP Flow Type : Veno" << std::endl; 
-			if(flowID == 5 || flowID == 6) std::cout << "TCP Flow Type : Vegas" << std::endl;  
-			std::cout << "Throughput : " << throughput << " Kbps"<< std::endl; 
-			std::cout << "Recevied Bytes : " << recv_bytes << std::endl; 
-			std::cout << "Time : " << t2-t1 << " s" << std::endl<< std::endl; 			    
+	//either the fixed packet sizes or an adaptive sweep refining where the curves change, which
+	//needs the results on every rank and is not available for a distributed run
+	std::vector<SweepPointResult> results = adaptive && GetRankCount() == 1 ? RunAdaptiveSweep(adaptiveOptions, runs, simulateBatch) : simulateBatch(MakeSweepJobs(packetSizes, runs));
+	if(cache)
+	{
+		std :: cout << "Result cache : " << cache->GetHits() << " hit(s), " << cache->GetMisses() << " miss(es)" << (cacheOnly ? ", misses not simulated" : "") << "\n";
+		if(!benchReport.empty() || !baseline.empty()) std :: cout << "Cached points are left out of the benchmark report and the baseline comparison\n";
+		std :: cout << "\n";
+	}
+	
+	//only rank 0 has the statistics of a distributed simulation
+	if(GetRank() != 0)
+	{
+		FinishMpi();
+		return 0;
+	}
+	
+	//buffer the records of the sweep, they are written in one go and feed the plots
+	ResultWriter writer;
+	writer.AddMetadata("program", "wired");
+	writer.AddMetadata("runs", std::to_string(runs));
+	writer.AddMetadata("workers", std::to_string(workers));
+	writer.AddMetadata("routing", config.routing);
+	writer.AddMetadata("scheduler", config.scheduler);
+	writer.AddMetadata("accounting", config.accounting);
+	writer.AddMetadata("dumbbell", config.dumbbell ? "1" : "0");
+	writer.AddMetadata("senders", std::to_string(config.senders));
+	writer.AddMetadata("ccMix", config.ccMix);
+	writer.AddMetadata("fct", config.fct ? "1" : "0");
+	writer.AddPoints(results);
+	if(output != "console")
+	{
+		writer.SetFormat(output);
+		writer.Write(outputFile);
+	}
+	
+	//machine readable run cost of the sweep and its comparison with a stored baseline
+	std::string benchMode = config.fct ? "fct" : config.dumbbell ? "dumbbell" : "wired";
+	if(!benchReport.empty())
+	{
+		WriteBenchmarkReport(benchReport, benchMode, results);
+	}
+	uint32_t regressions = 0;
+	if(!baseline.empty())
+	{
+		regressions = CompareWithBaseline(std::cout, ReadBenchmarkReport(baseline), benchMode, results, regressionThreshold);
+		std :: cout << std::endl;
+	}
+	
+	if(runs == 1)
+	{
+		//print the statistics unless they go to a file, and plot the same records in packet size order
+		if(output == "console")
+		{
+			for(const SweepPointResult& result : writer.GetPoints())
+			{
+				PrintSweepPoint(result);
+			}
+			std::cout.flush();
+		}
+		writer.FillDataset(dataset1, "avgThroughput");
+		writer.FillDataset(datasetFairness, "fairness");
+	}
+	else
+	{
+		//print the outcome of every replication
+		for(const SweepPointResult& result : results)
+		{
+			if(!result.ok) continue;
+			std::cout << "Packet-Size : " << result.packetSize << " Run : " << result.run
+			          << " Average Throughput: " << result.avgThroughput << " Kbps"
+			          << " FairnessIndex: " << result.fairness << "\n";
+		}
+		std :: cout << std::endl;
+		
+		//plot the mean of the replications with the 95% confidence interval as error bars
+		dataset1.SetErrorBars(Gnuplot2dDataset::Y);
+		datasetFairness.SetErrorBars(Gnuplot2dDataset::Y);
+		for(const ReplicationSummary& summary : SummarizeReplications(results))
+		{
+			PrintReplicationSummary(std::cout, summary, ciTarget);
+			dataset1.Add(summary.packetSize, summary.throughput.mean, summary.throughput.ciHalfWidth);
+			datasetFairness.Add(summary.packetSize, summary.fairness.mean, summary.fairness.ciHalfWidth);
 		}
-		    
-		avg_throughput = throughput_sum / 6.0;
-		dataset1.Add(packetSize[j], avg_throughput);
-		    
-		double fairness = (throughput_sum * throughput_sum) / (6.0 * throughput_square_sum);
-		datasetFairness.Add(packetSize[j], fairness);
-		std :: cout << "Average Throughput: " << avg_throughput << " Kbps" << std::endl;
-    	std :: cout << "FairnessIndex: " << fairness << std::endl;
-    		    
-    	std :: cout << "---------------------------------------------------------" << std::endl<< std::endl;
-		//std::cout << "Time Up. Stopped Application\n" ;
-		    
-		Simulator::Destroy();
 	}
 
 	// Instantiate the plot and set its title.
@@ -459,6 +1704,13 @@ int main(int argc, char* argv[])
 
 	// Close the plot file.
 	plotFile4.close();
-	     
-	return 0;
+	
+	//p50 and p99 one-way delay of every congestion control against the packet size
+	if(config.latency)
+	{
+		WriteLatencyPlot(writer, "Wired-Latency");
+	}
+	
+	FinishMpi();
+	return regressions > 0 ? 1 : 0;
 }
@@ -9,126 +9,322 @@
 #include "ns3/flow-monitor.h"
 #include "ns3/gnuplot.h"
 #include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
 #include "ns3/netanim-module.h"
 
+#include "adaptive-sweep.h"
+#include "animation-stream.h"
+#include "fast-wifi-link.h"
+#include "flow-accounting.h"
+#include "flow-sketch.h"
+#include "latency-histogram.h"
+#include "grid-spectrum-channel.h"
+#include "propagation-cache.h"
+#include "replication-stats.h"
+#include "result-cache.h"
+#include "result-writer.h"
+#include "routing-mode.h"
+#include "sampled-capture.h"
+#include "scheduler-type.h"
+#include "sim-benchmark.h"
+#include "steady-state-monitor.h"
+#include "throughput-sampler.h"
+#include "sweep-runner.h"
+#include "tcp-state-tracer.h"
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("TCPWirelessProgram");
 
-int main(int argc, char* argv[])
+//options of the wireless scenario that stay the same for every sweep point
+struct WirelessConfig
 {
+	uint32_t nWifi;         //number of wifi devices per base station
+	std::string accounting; //"flowmon" for FlowMonitor, "trace" for the trace based flow accounting or "sketch" for the bounded memory one
+	double sampleInterval;  //interval of the throughput/fairness time series in seconds, 0 disables it
+	bool steadyState;       //stop every sweep point once the flows have converged
+	double steadyWindow;    //length of one throughput window of the convergence monitor in seconds
+	uint32_t steadyHistory; //number of windows compared by the convergence monitor
+	double steadyTolerance; //relative change of mean and deviation accepted as converged
+	double warmup;          //time before which windows are discarded (slow start) in seconds
+	std::string routing;    //"global", "nix" or "static" routing, empty uses global
+	bool propagationCache;  //serve path loss and delay of the static nodes from a precomputed pairwise cache
+	std::string channel;    //"yans", "spectrum" or "grid" (spectrum channel delivering only within range)
+	double rxCutoff;        //received power in dBm below which the grid channel does not deliver a frame
+	std::string linkModel;  //"wifi" for the full 802.11 model or "fast" for the table driven abstract link
+	std::string fastTable;  //csv file of per attempt delivery probabilities of the fast link, empty is lossless
+	uint32_t mcs;           //HT MCS of the data frames
+	std::string scheduler;  //"map", "heap", "calendar", "list" or "priority" event scheduler, empty keeps the default
+	bool tcpTrace;          //record cwnd, rtt, ssthresh and congestion state of every flow to a binary file
+	uint32_t tcpTraceBuffer;//samples buffered per flow before the tcp state trace is written out
+	std::string capture;    //"packets" or "flows" sampling of the header capture of the AP devices, empty disables it
+	uint32_t captureOneIn;  //one in this many packets or flows is captured
+	uint32_t captureRecords;//records held by the capture ring
+	uint32_t captureSnap;   //bytes kept of every captured packet
+	uint32_t captureDropBurst;//drops within 100ms dumping the capture ring, 0 disables the trigger
+	double captureCollapse; //fraction of its previous value a cwnd falls below to dump the capture ring, 0 disables the trigger
+	bool latency;           //record one-way delay and jitter histograms of every flow and congestion control
+	uint32_t sketchTopFlows;//flows with the most received bytes listed with exact counters by the sketch accounting
+	uint32_t sketchMaxActive;//flows tracked at the same time by the sketch accounting before the oldest is folded
+	double sketchIdle;      //time without packets after which the sketch accounting folds a flow in seconds, 0 only folds evicted flows
+	double sketchAccuracy;  //relative error of the delay and jitter quantiles of the sketch accounting
+	bool anim;              //write a NetAnim trace of every sweep point
+	uint32_t animEvery;     //every this many packets is animated
+	std::string animWindows;//"start-stop,..." times in seconds outside of which no packet is animated, empty animates the whole run
+	bool animCompress;      //pipe the animation through gzip
+	uint32_t animBuffer;    //bytes of animation xml buffered before they are written out
+
+	//links, placement and applications given in assignment, not options; the result cache key is built from them too
+	std::string apRate;     //data rate of the AP-AP point-to-point link
+	std::string apDelay;    //delay of the AP-AP point-to-point link
+	WifiStandard standard;  //standard of both base stations
+	double gridDeltaX;      //spacing of the node grid in meters
+	double gridDeltaY;
+	uint32_t gridWidth;     //nodes in a row of the grid
+	std::string appRate;    //data rate of the OnOff sources
+	uint16_t sinkPort;      //port of the packet sink
+	double sinkStart;       //time the packet sink starts in seconds
+	double appStart;        //time the sources start in seconds
+	double simStop;         //time the simulation stops in seconds
+
+	WirelessConfig ()
+	: nWifi (1),
+	accounting ("flowmon"),
+	sampleInterval (0),
+	steadyState (false),
+	steadyWindow (0.1),
+	steadyHistory (20),
+	steadyTolerance (0.05),
+	warmup (10.2),
+	routing (""),
+	propagationCache (false),
+	channel ("yans"),
+	rxCutoff (-100.0),
+	linkModel ("wifi"),
+	fastTable (""),
+	mcs (7),
+	scheduler (""),
+	tcpTrace (false),
+	tcpTraceBuffer (1024),
+	capture (""),
+	captureOneIn (100),
+	captureRecords (4096),
+	captureSnap (64),
+	captureDropBurst (10),
+	captureCollapse (0.25),
+	latency (false),
+	sketchTopFlows (10),
+	sketchMaxActive (65536),
+	sketchIdle (0),
+	sketchAccuracy (0.01),
+	anim (false),
+	animEvery (1),
+	animWindows (""),
+	animCompress (true),
+	animBuffer (65536),
+	apRate ("10Mbps"),
+	apDelay ("100ms"),
+	standard (WIFI_STANDARD_80211n),
+	gridDeltaX (5.0),
+	gridDeltaY (10.0),
+	gridWidth (4),
+	appRate ("100Mbps"),
+	sinkPort (8080),
+	sinkStart (0.0),
+	appStart (10.0),
+	simStop (11.0)
+	{
+	}
+};
 
-	//declare number of wifi devices per base station
-	uint32_t nWifi = 1;
+//channel of one base station and the propagation models it uses
+struct BssChannel
+{
+	Ptr<YansWifiChannel> yans;                  //set for the yans channel
+	Ptr<SpectrumChannel> spectrum;              //set for the spectrum and grid channels
+	Ptr<GridSpectrumChannel> grid;              //set for the grid channel
+	Ptr<CachedPropagationLossModel> lossCache;  //set when the propagation cache is used
+	Ptr<CachedPropagationDelayModel> delayCache;
+};
+
+//create the channel of one base station. Without the propagation cache the yans channel is
+//exactly YansWifiChannelHelper::Default (); every other variant uses the same log-distance loss
+//and constant speed delay models, cached for every pair of nodes until one of them moves if
+//the propagation cache is enabled
+BssChannel CreateBssChannel(const WirelessConfig& config)
+{
+	BssChannel bss;
+	if (config.channel == "yans" && !config.propagationCache)
+	{
+		bss.yans = YansWifiChannelHelper::Default ().Create ();
+		return bss;
+	}
 
-	//declare variables for plotting throughput and fairness
-	std::string graphicsFileName1, graphicsFileNameFairness;
-	std::string plotFileName1, plotFileNameFairness;
-	std::string plotTitle;
-	std::string dataTitle;
+	Ptr<PropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+	Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+	if (config.propagationCache)
+	{
+		bss.lossCache = CreateObject<CachedPropagationLossModel> ();
+		bss.lossCache->SetModel (loss);
+		bss.delayCache = CreateObject<CachedPropagationDelayModel> ();
+		bss.delayCache->SetModel (delay);
+		loss = bss.lossCache;
+		delay = bss.delayCache;
+	}
 
-	//create datasets for throughput and fairness graphs
-	Gnuplot2dDataset dataset1, datasetFairness;
-	dataTitle = "Throughput";
-    
-	// Instantiate the dataset, set its title, and make the points be
-	// plotted along with connecting lines. 
-	dataset1.SetTitle(dataTitle);
-	dataset1.SetStyle(Gnuplot2dDataset::LINES_POINTS);
+	if (config.channel == "yans")
+	{
+		bss.yans = CreateObject<YansWifiChannel> ();
+		bss.yans->SetPropagationLossModel (loss);
+		bss.yans->SetPropagationDelayModel (delay);
+		return bss;
+	}
+	if (config.channel == "spectrum")
+	{
+		bss.spectrum = CreateObject<SingleModelSpectrumChannel> ();
+	}
+	else if (config.channel == "grid")
+	{
+		bss.grid = CreateObject<GridSpectrumChannel> ();
+		bss.grid->SetAttribute ("RxCutoff", DoubleValue (config.rxCutoff));
+		bss.spectrum = bss.grid;
+	}
+	else
+	{
+		NS_FATAL_ERROR ("Unknown channel " << config.channel << ", use yans, spectrum or grid");
+	}
+	bss.spectrum->AddPropagationLossModel (loss);
+	bss.spectrum->SetPropagationDelayModel (delay);
+	return bss;
+}
 
-	//create filenames for throughput and fairness graphs
-	datasetFairness.SetTitle("Fairness");
-	datasetFairness.SetStyle(Gnuplot2dDataset::LINES_POINTS);
-    
-	//set extensions for filename
-	std::string fileNameWithNoExtension1 = "Wireless-Throughput";
-	std::string fileNameWithNoExtensionFairness = "Wireless-Fairness";
-    
-	graphicsFileName1 = fileNameWithNoExtension1 + ".png";
-	plotFileName1 = fileNameWithNoExtension1 + ".plt";
-	plotTitle = "Throughput Vs Packet Sizes";
+//congestion control of the three flows of the wireless topology, in the order their sources are installed
+const char* const WIRELESS_TCP_TYPES[3] = {"ns3::TcpWestwood", "ns3::TcpVeno", "ns3::TcpVegas"};
 
-	graphicsFileNameFairness = fileNameWithNoExtensionFairness + ".png";
-	plotFileNameFairness = fileNameWithNoExtensionFairness + ".plt";
-   
-	//store packet sizes required in an array
-	uint32_t packetSize[10] = {40, 44, 48, 52, 60, 552, 576, 628, 1420, 1500};
-	std :: cout << "---------------------------------------------------------" << std::endl<< std::endl;
-	for(int j = 0 ; j < 10 ; j++)
-	{
-		//Configure TCP Segment Size
-		Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (packetSize[j]));
+//simulate the wireless topology for one packet size and collect the per-flow statistics
+SweepPointResult SimulateWireless(const SweepJob& job, const WirelessConfig& config)
+{
+	//ps stores current packet size
+	uint32_t ps = job.packetSize;
+	uint32_t nWifi = config.nWifi;
 
-		//create the 2 nodes with point-to-point connection
-		NodeContainer p2pNodes;
-		p2pNodes.Create (2);
+	//measure the memory and time used by this sweep point
+	RunProbe probe;
+	probe.Start();
 
-		//declare helper for creating point-to-point link and set data rate and delay values given in assignment
-		PointToPointHelper pointToPoint;
-		pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
-		pointToPoint.SetChannelAttribute ("Delay", StringValue ("100ms"));
+	//select the rng run so that every replication sees independent random streams
+	RngSeedManager::SetRun(job.run);
+	SelectScheduler(config.scheduler);
 
-		//Install the devices as end points of the point-to-point channel
-		NetDeviceContainer p2pDevices;
-		p2pDevices = pointToPoint.Install (p2pNodes);
+	//Configure TCP Segment Size
+	Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (ps));
 
-		//Create tcp source node
-		NodeContainer wifiStaNode0;
-		wifiStaNode0.Create (nWifi);
+	//create the 2 nodes with point-to-point connection
+	NodeContainer p2pNodes;
+	p2pNodes.Create (2);
 
-		//Create tcp sink node
-		NodeContainer wifiStaNode1;
-		wifiStaNode1.Create (nWifi);
+	//declare helper for creating point-to-point link and set data rate and delay values given in assignment
+	PointToPointHelper pointToPoint;
+	pointToPoint.SetDeviceAttribute ("DataRate", StringValue (config.apRate));
+	pointToPoint.SetChannelAttribute ("Delay", StringValue (config.apDelay));
 
-		//Create the base station nodes using the point-to-point nodes
-		NodeContainer wifiApNodeBS1 = p2pNodes.Get (0);
-		NodeContainer wifiApNodeBS2 = p2pNodes.Get (1);
+	//Install the devices as end points of the point-to-point channel
+	NetDeviceContainer p2pDevices;
+	p2pDevices = pointToPoint.Install (p2pNodes);
 
-		//Create channel and phy layer helper for both base stations
-		YansWifiChannelHelper channelBS1 = YansWifiChannelHelper::Default ();
-		YansWifiPhyHelper phyBS1 = YansWifiPhyHelper();
+	//Create tcp source node
+	NodeContainer wifiStaNode0;
+	wifiStaNode0.Create (nWifi);
 
-		YansWifiChannelHelper channelBS2 = YansWifiChannelHelper::Default ();
-		YansWifiPhyHelper phyBS2 = YansWifiPhyHelper();
+	//Create tcp sink node
+	NodeContainer wifiStaNode1;
+	wifiStaNode1.Create (nWifi);
 
-		phyBS1.SetChannel (channelBS1.Create ());
-		phyBS2.SetChannel (channelBS2.Create ());
+	//Create the base station nodes using the point-to-point nodes
+	NodeContainer wifiApNodeBS1 = p2pNodes.Get (0);
+	NodeContainer wifiApNodeBS2 = p2pNodes.Get (1);
 
-		//create service set identifiers for both base stations
-		WifiMacHelper macBS1;
-		Ssid ssidBS1 = Ssid ("ns-3-ssid");
+	//Create channel and phy layer helper for both base stations
+	BssChannel channelBS1 = CreateBssChannel (config);
+	YansWifiPhyHelper yansPhyBS1 = YansWifiPhyHelper();
+	SpectrumWifiPhyHelper spectrumPhyBS1;
 
-		WifiMacHelper macBS2;
-		Ssid ssidBS2 = Ssid ("ns-3-ssid");
+	BssChannel channelBS2 = CreateBssChannel (config);
+	YansWifiPhyHelper yansPhyBS2 = YansWifiPhyHelper();
+	SpectrumWifiPhyHelper spectrumPhyBS2;
 
-		//Create wifi helper and set wifi standard    
-		WifiHelper wifiBS1;
-		WifiHelper wifiBS2;
+	if (channelBS1.yans)
+	{
+		yansPhyBS1.SetChannel (channelBS1.yans);
+		yansPhyBS2.SetChannel (channelBS2.yans);
+	}
+	else
+	{
+		spectrumPhyBS1.SetChannel (channelBS1.spectrum);
+		spectrumPhyBS2.SetChannel (channelBS2.spectrum);
+	}
+	const WifiPhyHelper& phyBS1 = channelBS1.yans ? static_cast<const WifiPhyHelper&> (yansPhyBS1) : spectrumPhyBS1;
+	const WifiPhyHelper& phyBS2 = channelBS2.yans ? static_cast<const WifiPhyHelper&> (yansPhyBS2) : spectrumPhyBS2;
+
+	//create service set identifiers for both base stations
+	WifiMacHelper macBS1;
+	Ssid ssidBS1 = Ssid ("ns-3-ssid");
+
+	WifiMacHelper macBS2;
+	Ssid ssidBS2 = Ssid ("ns-3-ssid");
 
-		wifiBS1.SetStandard (WIFI_STANDARD_80211n);
-		wifiBS2.SetStandard (WIFI_STANDARD_80211n);
+	//Create wifi helper and set wifi standard    
+	WifiHelper wifiBS1;
+	WifiHelper wifiBS2;
 
-		//configure station manager
-		wifiBS1.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue ("HtMcs7"),"ControlMode", StringValue ("HtMcs0"));
-		wifiBS2.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue ("HtMcs7"),"ControlMode", StringValue ("HtMcs0"));
+	wifiBS1.SetStandard (config.standard);
+	wifiBS2.SetStandard (config.standard);
 
-		//Configure mac layer values for wifi nodes
-		macBS1.SetType ("ns3::StaWifiMac",
-		"Ssid", SsidValue (ssidBS1),
-		"ActiveProbing", BooleanValue (false));
+	//configure station manager
+	std::string dataMode = "HtMcs" + std::to_string (config.mcs);
+	wifiBS1.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue (dataMode),"ControlMode", StringValue ("HtMcs0"));
+	wifiBS2.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue (dataMode),"ControlMode", StringValue ("HtMcs0"));
 
-		macBS2.SetType ("ns3::StaWifiMac",
-		"Ssid", SsidValue (ssidBS2),
-		"ActiveProbing", BooleanValue (false));
+	//Configure mac layer values for wifi nodes
+	macBS1.SetType ("ns3::StaWifiMac",
+	"Ssid", SsidValue (ssidBS1),
+	"ActiveProbing", BooleanValue (false));
 
-		// Set channel width
-		//Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (2000));
+	macBS2.SetType ("ns3::StaWifiMac",
+	"Ssid", SsidValue (ssidBS2),
+	"ActiveProbing", BooleanValue (false));
 
+	// Set channel width
+	//Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (2000));
+
+	NetDeviceContainer staDevice0;
+	NetDeviceContainer staDevice1;
+	NetDeviceContainer apDevicesBS1;
+	NetDeviceContainer apDevicesBS2;
+	if (config.linkModel == "fast")
+	{
+		//replace each BSS by the abstract link, the stations come first and the AP last
+		FastWifiLinkTable table;
+		if (!config.fastTable.empty ())
+		{
+			table.Load (config.fastTable);
+		}
+		//retransmissions are charged for the data packets: a segment with ip and tcp headers and
+		//the timestamp option
+		NetDeviceContainer devicesBS1 = InstallFastWifiLink (NodeContainer (wifiStaNode0, wifiApNodeBS1), table, config.mcs, ps + 52);
+		NetDeviceContainer devicesBS2 = InstallFastWifiLink (NodeContainer (wifiStaNode1, wifiApNodeBS2), table, config.mcs, ps + 52);
+		for (uint32_t i = 0; i < nWifi; i++)
+		{
+			staDevice0.Add (devicesBS1.Get (i));
+			staDevice1.Add (devicesBS2.Get (i));
+		}
+		apDevicesBS1.Add (devicesBS1.Get (nWifi));
+		apDevicesBS2.Add (devicesBS2.Get (nWifi));
+	}
+	else
+	{
 		//install wifi models to both the wifi nodes
-		NetDeviceContainer staDevice0;
 		staDevice0 = wifiBS1.Install (phyBS1, macBS1, wifiStaNode0);
-
-		NetDeviceContainer staDevice1;
 		staDevice1 = wifiBS2.Install (phyBS2, macBS1, wifiStaNode1);
 
 		//Configure mac layer values for base stations nodes, setting them as access point(AP) nodes
@@ -136,200 +332,833 @@ int main(int argc, char* argv[])
 		macBS2.SetType ("ns3::ApWifiMac","Ssid", SsidValue (ssidBS2));
 
 		//install wifi models to both the wifi base stations
-		NetDeviceContainer apDevicesBS1;
 		apDevicesBS1 = wifiBS1.Install (phyBS1, macBS2, wifiApNodeBS1);
-
-		NetDeviceContainer apDevicesBS2;
 		apDevicesBS2 = wifiBS2.Install (phyBS2, macBS2, wifiApNodeBS2);
+	}
 
-		//Set the location of all nodes using MobilityHelper and keep them steady
-		MobilityHelper mobility;
-
-		mobility.SetPositionAllocator ("ns3::GridPositionAllocator", 
-										"MinX", 
-										DoubleValue (0.0), 
-										"MinY", DoubleValue (0.0), 
-										"DeltaX", DoubleValue (5.0),
-										"DeltaY", DoubleValue (10.0), 
-										"GridWidth", UintegerValue (4), 
-										"LayoutType", 
-										StringValue ("RowFirst"));
-
-		mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-		mobility.Install (wifiStaNode0);
-		mobility.Install (wifiApNodeBS1);
-		mobility.Install (wifiApNodeBS2);
-		mobility.Install (wifiStaNode1);
-
-		//install internet stack on all nodes
-		InternetStackHelper stack;
-		stack.Install (wifiApNodeBS1);
-		stack.Install (wifiStaNode0);
-		stack.Install (wifiApNodeBS2);
-		stack.Install (wifiStaNode1);
-
-		//assign ipv4 addresses to all devices
-		Ipv4AddressHelper address;
-
-		address.SetBase ("10.1.1.0", "255.255.255.0");
-		Ipv4InterfaceContainer p2pInterfaces;
-		p2pInterfaces = address.Assign (p2pDevices);
-
-		address.SetBase ("10.1.2.0", "255.255.255.0");
-		Ipv4InterfaceContainer wifiInterfaceContainer0 = address.Assign (staDevice0);
-		address.Assign (apDevicesBS1);
-
-		address.SetBase ("10.1.3.0", "255.255.255.0");
-		Ipv4InterfaceContainer wifiInterfaceContainer1 = address.Assign (staDevice1);
-		address.Assign (apDevicesBS2);
-
-		//use global routing and create routing tables
-		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-
-		//ps stores current packet size
-		uint32_t ps = packetSize[j];
-
-		//set tcp congestion control algorithm as Westwood for source node n0
-		TypeId tid = TypeId::LookupByName("ns3::TcpWestwood");
-		std::stringstream nodeId;
-		nodeId << wifiStaNode0.Get(0)->GetId();
-		std::string specificNode = "/NodeList/" + nodeId.str() + "/$ns3::TcpL4Protocol/SocketType";
-		Config::Set(specificNode, TypeIdValue(tid));
-	    
-		//use 8080 as sink port	    
-		uint16_t sinkPort = 8080;
-	
-		//create socket and tcp sink application and install it on node n1	    
-		Address sinkAddress (InetSocketAddress(wifiInterfaceContainer1.GetAddress (0), sinkPort));
-		PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
-		ApplicationContainer sinkApps = packetSinkHelper.Install (wifiStaNode1.Get (0));
-		sinkApps.Start (Seconds (0.));
-
-		//create and install tcp source application with congestion control algorithm as Westwood on node n2 using our custom made application class "MyApp"
-		OnOffHelper serverHelper1 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
-		serverHelper1.SetAttribute ("PacketSize", UintegerValue (ps));
-		serverHelper1.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-		serverHelper1.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-		serverHelper1.SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
-		//serverHelper1.SetAttribute ("MaxBytes", UintegerValue(5*ps));
-
-		ApplicationContainer serverApp1 = serverHelper1.Install (wifiStaNode0.Get(0));
-
-		//set tcp congestion control algorithm as Veno for source node n0
-		tid = TypeId::LookupByName("ns3::TcpVeno");
-		Config::Set(specificNode, TypeIdValue(tid));
-
-		//create and install tcp source application with congestion control algorithm as Veno on node n0 using our custom made application class "MyApp"
-		OnOffHelper serverHelper2 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
-		serverHelper2.SetAttribute ("PacketSize", UintegerValue (ps));
-		serverHelper2.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-		serverHelper2.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-		serverHelper2.SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
-		//serverHelper2.SetAttribute ("MaxBytes", UintegerValue(5*ps));
-
-		ApplicationContainer serverApp2 = serverHelper2.Install (wifiStaNode0.Get(0));
-
-		//set tcp congestion control algorithm as Vegas for source node n0
-		tid = TypeId::LookupByName("ns3::TcpVegas");
-		Config::Set(specificNode, TypeIdValue(tid));
-
-		//create and install tcp source application with congestion control algorithm as Vegas on node n0 using our custom made application class "MyApp"
-		OnOffHelper serverHelper3 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
-		serverHelper3.SetAttribute ("PacketSize", UintegerValue (ps));
-		serverHelper3.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-		serverHelper3.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-		serverHelper3.SetAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
-		//serverHelper3.SetAttribute ("MaxBytes", UintegerValue(5*ps));
-
-		ApplicationContainer serverApp3 = serverHelper3.Install (wifiStaNode0.Get(0));
-
-		//Start all applications
-		serverApp1.Start (Seconds (10.0));
-		serverApp2.Start (Seconds (10.0));
-		serverApp3.Start (Seconds (10.0));
-
-		//create flow monitor
-		Ptr<FlowMonitor> flowMonitor;
-		FlowMonitorHelper flowHelper;
+	//Set the location of all nodes using MobilityHelper and keep them steady
+	MobilityHelper mobility;
+
+	mobility.SetPositionAllocator ("ns3::GridPositionAllocator", 
+									"MinX", 
+									DoubleValue (0.0), 
+									"MinY", DoubleValue (0.0), 
+									"DeltaX", DoubleValue (config.gridDeltaX),
+									"DeltaY", DoubleValue (config.gridDeltaY), 
+									"GridWidth", UintegerValue (config.gridWidth), 
+									"LayoutType", 
+									StringValue ("RowFirst"));
+
+	mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+	mobility.Install (wifiStaNode0);
+	mobility.Install (wifiApNodeBS1);
+	mobility.Install (wifiApNodeBS2);
+	mobility.Install (wifiStaNode1);
+
+	//fill the loss and delay matrices of both channels before the simulation starts
+	if (config.propagationCache)
+	{
+		NodeContainer nodesBS1 (wifiApNodeBS1, wifiStaNode0);
+		NodeContainer nodesBS2 (wifiApNodeBS2, wifiStaNode1);
+		channelBS1.lossCache->Precompute (nodesBS1);
+		channelBS1.delayCache->Precompute (nodesBS1);
+		channelBS2.lossCache->Precompute (nodesBS2);
+		channelBS2.delayCache->Precompute (nodesBS2);
+	}
+
+	//install internet stack on all nodes, with nix-vector routing if selected
+	RoutingMode routing = ParseRoutingMode (config.routing, ROUTING_GLOBAL);
+	InternetStackHelper stack;
+	SetStackRouting (stack, routing);
+	stack.Install (wifiApNodeBS1);
+	stack.Install (wifiStaNode0);
+	stack.Install (wifiApNodeBS2);
+	stack.Install (wifiStaNode1);
+
+	//assign ipv4 addresses to all devices
+	Ipv4AddressHelper address;
+
+	address.SetBase ("10.1.1.0", "255.255.255.0");
+	Ipv4InterfaceContainer p2pInterfaces;
+	p2pInterfaces = address.Assign (p2pDevices);
+
+	address.SetBase ("10.1.2.0", "255.255.255.0");
+	Ipv4InterfaceContainer wifiInterfaceContainer0 = address.Assign (staDevice0);
+	Ipv4InterfaceContainer apInterfaceBS1 = address.Assign (apDevicesBS1);
+
+	address.SetBase ("10.1.3.0", "255.255.255.0");
+	Ipv4InterfaceContainer wifiInterfaceContainer1 = address.Assign (staDevice1);
+	Ipv4InterfaceContainer apInterfaceBS2 = address.Assign (apDevicesBS2);
+
+	//use global routing and create routing tables, or route the stations of each BSS through
+	//their access point and the access points through the point-to-point link
+	for (uint32_t i = 0; i < nWifi; i++)
+	{
+		AddDefaultRoute (routing, staDevice0.Get (i), apInterfaceBS1.GetAddress (0));
+		AddDefaultRoute (routing, staDevice1.Get (i), apInterfaceBS2.GetAddress (0));
+	}
+	AddDefaultRoute (routing, p2pDevices.Get (0), p2pInterfaces.GetAddress (1));
+	AddDefaultRoute (routing, p2pDevices.Get (1), p2pInterfaces.GetAddress (0));
+	PopulateRoutes (routing);
+
+
+	//set tcp congestion control algorithm as Westwood for source node n0
+	TypeId tid = TypeId::LookupByName(WIRELESS_TCP_TYPES[0]);
+	std::stringstream nodeId;
+	nodeId << wifiStaNode0.Get(0)->GetId();
+	std::string specificNode = "/NodeList/" + nodeId.str() + "/$ns3::TcpL4Protocol/SocketType";
+	Config::Set(specificNode, TypeIdValue(tid));
+    
+	//use 8080 as sink port	    
+	uint16_t sinkPort = config.sinkPort;
+
+	//create socket and tcp sink application and install it on node n1	    
+	Address sinkAddress (InetSocketAddress(wifiInterfaceContainer1.GetAddress (0), sinkPort));
+	PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
+	ApplicationContainer sinkApps = packetSinkHelper.Install (wifiStaNode1.Get (0));
+	sinkApps.Start (Seconds (config.sinkStart));
+
+	//create and install tcp source application with congestion control algorithm as Westwood on node n2 using our custom made application class "MyApp"
+	OnOffHelper serverHelper1 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
+	serverHelper1.SetAttribute ("PacketSize", UintegerValue (ps));
+	serverHelper1.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+	serverHelper1.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+	serverHelper1.SetAttribute ("DataRate", DataRateValue (DataRate (config.appRate)));
+	//serverHelper1.SetAttribute ("MaxBytes", UintegerValue(5*ps));
+
+	ApplicationContainer serverApp1 = serverHelper1.Install (wifiStaNode0.Get(0));
+
+	//set tcp congestion control algorithm as Veno for source node n0
+	tid = TypeId::LookupByName(WIRELESS_TCP_TYPES[1]);
+	Config::Set(specificNode, TypeIdValue(tid));
+
+	//create and install tcp source application with congestion control algorithm as Veno on node n0 using our custom made application class "MyApp"
+	OnOffHelper serverHelper2 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
+	serverHelper2.SetAttribute ("PacketSize", UintegerValue (ps));
+	serverHelper2.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+	serverHelper2.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+	serverHelper2.SetAttribute ("DataRate", DataRateValue (DataRate (config.appRate)));
+	//serverHelper2.SetAttribute ("MaxBytes", UintegerValue(5*ps));
+
+	ApplicationContainer serverApp2 = serverHelper2.Install (wifiStaNode0.Get(0));
+
+	//set tcp congestion control algorithm as Vegas for source node n0
+	tid = TypeId::LookupByName(WIRELESS_TCP_TYPES[2]);
+	Config::Set(specificNode, TypeIdValue(tid));
+
+	//create and install tcp source application with congestion control algorithm as Vegas on node n0 using our custom made application class "MyApp"
+	OnOffHelper serverHelper3 ("ns3::TcpSocketFactory", (InetSocketAddress (wifiInterfaceContainer1.GetAddress (0), sinkPort)));
+	serverHelper3.SetAttribute ("PacketSize", UintegerValue (ps));
+	serverHelper3.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+	serverHelper3.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+	serverHelper3.SetAttribute ("DataRate", DataRateValue (DataRate (config.appRate)));
+	//serverHelper3.SetAttribute ("MaxBytes", UintegerValue(5*ps));
+
+	ApplicationContainer serverApp3 = serverHelper3.Install (wifiStaNode0.Get(0));
+
+	//Start all applications
+	serverApp1.Start (Seconds (config.appStart));
+	serverApp2.Start (Seconds (config.appStart));
+	serverApp3.Start (Seconds (config.appStart));
+
+	//trace the congestion control state of the three flows, their sockets are created when they start
+	std::unique_ptr<TcpStateTracer> tcpTracer;
+	if(config.tcpTrace)
+	{
+		std::ostringstream traceFileName;
+		traceFileName << "Wireless-TcpState-" << ps << "-" << job.run << ".bin";
+		tcpTracer.reset(new TcpStateTracer(traceFileName.str(), config.tcpTraceBuffer));
+		tcpTracer->AddApplicationSocket(serverApp1.Get(0), Seconds(config.appStart), "Westwood");
+		tcpTracer->AddApplicationSocket(serverApp2.Get(0), Seconds(config.appStart), "Veno");
+		tcpTracer->AddApplicationSocket(serverApp3.Get(0), Seconds(config.appStart), "Vegas");
+	}
+
+	//create flow monitor, or only hook the application traces for the lightweight accounting
+	Ptr<FlowMonitor> flowMonitor;
+	FlowMonitorHelper flowHelper;
+	FlowAccounting accounting;
+	//the sources are also hooked for flow monitor, which finds the congestion control of a flow by its source port
+	if(config.accounting != "sketch" || config.sampleInterval > 0 || config.steadyState)
+	{
+		accounting.AddSource(serverApp1.Get(0), "Westwood");
+		accounting.AddSource(serverApp2.Get(0), "Veno");
+		accounting.AddSource(serverApp3.Get(0), "Vegas");
+	}
+	if(config.accounting == "trace" || config.sampleInterval > 0 || config.steadyState)
+	{
+		accounting.AddSink(sinkApps.Get(0));
+	}
+	std::unique_ptr<SketchAccounting> sketch;
+	if(config.accounting == "sketch")
+	{
+		sketch.reset(new SketchAccounting(config.sketchTopFlows, config.sketchMaxActive, Seconds(config.sketchIdle), config.sketchAccuracy));
+		sketch->AddSource(serverApp1.Get(0), "Westwood");
+		sketch->AddSource(serverApp2.Get(0), "Veno");
+		sketch->AddSource(serverApp3.Get(0), "Vegas");
+		sketch->AddSink(sinkApps.Get(0));
+		sketch->Start();
+	}
+	else if(config.accounting != "trace")
+	{
 		flowMonitor = flowHelper.InstallAll();
+	}
 
-		/*
-		AnimationInterface anim("wireless.xml");
-		anim.SetConstantPosition(wifiStaNode0.Get(0), 0.0, 0.0);
-		anim.SetConstantPosition(wifiApNodeBS1.Get(0), 5.0, 0.0);
-		anim.SetConstantPosition(wifiApNodeBS2.Get(0), 10.0, 0.0);
-		anim.SetConstantPosition(wifiStaNode1.Get(0), 15.0, 0.0);
-		*/
+	//sampled header capture of the wifi interfaces of both APs, dumped when the AP-AP link and AP
+	//queue discs and queues or the AP macs drop a burst or a flow times out
+	std::unique_ptr<SampledCapture> capture;
+	if(!config.capture.empty())
+	{
+		std::ostringstream capturePrefix;
+		capturePrefix << "Wireless-Capture-" << ps << "-" << job.run;
+		capture.reset(new SampledCapture(capturePrefix.str(), config.captureRecords, config.captureSnap));
+		capture->SetSampling(ParseCaptureMode(config.capture), config.captureOneIn);
+		capture->SetDropBurstTrigger(config.captureDropBurst, MilliSeconds(100));
+		capture->SetCwndCollapseTrigger(config.captureCollapse);
+		capture->InstallIpv4Interface(apDevicesBS1.Get(0));
+		capture->InstallIpv4Interface(apDevicesBS2.Get(0));
+		capture->AddQueueDropTraces(p2pDevices.Get(0));
+		capture->AddQueueDropTraces(p2pDevices.Get(1));
+		for(Ptr<NetDevice> device : {apDevicesBS1.Get(0), apDevicesBS2.Get(0)})
+		{
+			capture->AddQueueDropTraces(device);
+			Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice>(device);
+			if(wifiDevice) capture->AddDropTrace(wifiDevice->GetMac(), "MacTxDrop");
+		}
+		capture->AddApplicationCwndTrace(serverApp1.Get(0), Seconds(config.appStart));
+		capture->AddApplicationCwndTrace(serverApp2.Get(0), Seconds(config.appStart));
+		capture->AddApplicationCwndTrace(serverApp3.Get(0), Seconds(config.appStart));
+	}
 
-		Simulator::Stop(Seconds(11.0));
-		Simulator::Run();
-		    
+	//delay and jitter histograms of the three flows
+	std::unique_ptr<LatencyTracker> latency;
+	if(config.latency)
+	{
+		latency.reset(new LatencyTracker(true));
+		latency->AddSource(serverApp1.Get(0), "Westwood");
+		latency->AddSource(serverApp2.Get(0), "Veno");
+		latency->AddSource(serverApp3.Get(0), "Vegas");
+		latency->AddSink(sinkApps.Get(0));
+	}
+
+	//stream the windowed throughput and fairness of the flows to a file while the simulation runs
+	std::unique_ptr<ThroughputSampler> sampler;
+	if(config.sampleInterval > 0)
+	{
+		std::ostringstream sampleFileName;
+		sampleFileName << "Wireless-Samples-" << ps << "-" << job.run << ".csv";
+		sampler.reset(new ThroughputSampler(accounting, Seconds(config.sampleInterval), sampleFileName.str()));
+		sampler->Start();
+	}
+
+	//stop the simulation early once the throughput of all flows has converged
+	std::unique_ptr<SteadyStateMonitor> steadyMonitor;
+	if(config.steadyState)
+	{
+		steadyMonitor.reset(new SteadyStateMonitor(accounting, Seconds(config.steadyWindow), config.steadyHistory, config.steadyTolerance, Seconds(config.warmup)));
+		steadyMonitor->Start();
+	}
+
+	//decimated NetAnim trace of the AP-AP link and both BSS, the nodes at their grid positions
+	std::unique_ptr<AnimationStream> animation;
+	if(config.anim)
+	{
+		std::ostringstream animFileName;
+		animFileName << "Wireless-Anim-" << ps << "-" << job.run << (config.animCompress ? ".xml.gz" : ".xml");
+		animation.reset(new AnimationStream(animFileName.str(), config.animBuffer));
+		animation->SetDecimation(config.animEvery);
+		ParseAnimationWindows(config.animWindows, *animation);
+		for(NodeContainer::Iterator node = NodeContainer::GetGlobal().Begin(); node != NodeContainer::GetGlobal().End(); node++)
+		{
+			animation->AddNode(*node);
+		}
+		animation->AddDevices(p2pDevices);
+		animation->AddDevices(staDevice0);
+		animation->AddDevices(apDevicesBS1);
+		animation->AddDevices(apDevicesBS2);
+		animation->AddDevices(staDevice1);
+	}
+
+	Simulator::Stop(Seconds(config.simStop));
+	probe.BeginRun();
+	Simulator::Run();
+	probe.EndRun();
+	if(sampler) sampler->Finish();
+	if(tcpTracer) tcpTracer->Finish();
+	if(capture) capture->Finish();
+	if(animation) animation->Finish();
+	    
+	SweepPointResult result;
+	result.packetSize = ps;
+	result.run = job.run;
+	if(flowMonitor)
+	{
 		//obtain the flow statistics from flow monitor		    
-		FlowMonitor :: FlowStatsContainer fsc = flowMonitor->GetFlowStats();
-		if(fsc.empty()) std::cout << "No flow";
-		FlowMonitor :: FlowStatsContainerI it;
-		//uint32_t flowID;
+		const FlowMonitor :: FlowStatsContainer& fsc = flowMonitor->GetFlowStats();
+		FlowMonitor :: FlowStatsContainerCI it;
 
 		//throughput is calculated as (number of bits received by sink) / (time when last packet was received - time when first packet was transmitted)
 		//jain's fairness index = (sum of throughputs)^2 / (number of flows * sum of squares of throughputs)
-		uint32_t flowID;
-		double avg_throughput = 0.0;
+		//over all 6 flows, and separately over the data flows to the sink only to compare with the trace accounting
+		Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowHelper.GetClassifier());
 		double throughput_sum = 0.0, throughput_square_sum = 0.0;
+		double data_throughput_sum = 0.0, data_throughput_square_sum = 0.0;
+		uint32_t dataFlows = 0;
 
-		std::cout << "Packet-Size : " << ps << std::endl<< std::endl;
 		for(it = fsc.begin() ; it != fsc.end(); it++)
 		{
-			FlowMonitor :: FlowStats fs = it->second;
-			flowID = it->first;
-			uint64_t recv_bytes = fs.rxBytes;
-			Time t = fs.timeFirstTxPacket;
-			double t1 = t.GetSeconds();
-			t = fs.timeLastRxPacket;
-			double t2 = t.GetSeconds();
-			    
-			double throughput = (recv_bytes * 8.0) / (t2-t1);
-			throughput = throughput / 1024;
-			throughput_sum += throughput;
-			throughput_square_sum += throughput * throughput;
-			    
-			if(flowID == 1 || flowID == 2 || flowID == 3) 
-			{	
-				std::cout << "n0 ---> n1" << std::endl;
-			}
-			else 
+			const FlowMonitor :: FlowStats& fs = it->second;
+
+			FlowResult flow;
+			flow.flowId = it->first;
+			flow.rxBytes = fs.rxBytes;
+			flow.firstTx = fs.timeFirstTxPacket.GetSeconds();
+			flow.lastRx = fs.timeLastRxPacket.GetSeconds();
+
+			//mean one-way delay and jitter of the flow from the sums kept by flow monitor
+			if(fs.rxPackets > 0) result.metrics["flowmonDelayMeanMs." + std::to_string(flow.flowId)] = 1000 * fs.delaySum.GetSeconds() / fs.rxPackets;
+			if(fs.rxPackets > 1) result.metrics["flowmonJitterMeanMs." + std::to_string(flow.flowId)] = 1000 * fs.jitterSum.GetSeconds() / (fs.rxPackets - 1);
+		    
+			double throughput = (flow.rxBytes * 8.0) / (flow.lastRx - flow.firstTx);
+			flow.throughput = throughput / 1024;
+			throughput_sum += flow.throughput;
+			throughput_square_sum += flow.throughput * flow.throughput;
+			
+			//data flows are sent from the port of a source, the ACK flows back to it
+			Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow(it->first);
+			if(tuple.destinationPort == sinkPort)
 			{
-				std::cout << "n1 ---> n0" << std::endl;
-			}
-			if(flowID == 1 || flowID == 2) 
-			{	
-				std::cout << "TCP Flow Type : Westwood" << std::endl;
+				flow.type = accounting.GetFlowType(tuple.sourceAddress, tuple.sourcePort);
+				data_throughput_sum += flow.throughput;
+				data_throughput_square_sum += flow.throughput * flow.throughput;
+				dataFlows++;
 			}
-			if(flowID == 3 || flowID == 4) 
-			{	
-				std::cout << "TCP Flow Type : Veno" << std::endl; 
-			}
-			if(flowID == 5 || flowID == 6) 
-			{	
-				std::cout << "TCP Flow Type : Vegas" << std::endl;  
+			else
+			{
+				flow.type = accounting.GetFlowType(tuple.destinationAddress, tuple.destinationPort);
 			}
-			std::cout << "Throughput : " << throughput << " Kbps"<< std::endl; 
-			std::cout << "Recevied Bytes : " << recv_bytes << std::endl; 
-			std::cout << "Time : " << t2-t1 << " s" << std::endl<< std::endl; 
-			    
+			result.flows.push_back(flow);
 		}
-		avg_throughput = throughput_sum / 6.0;
-		dataset1.Add(packetSize[j], avg_throughput);
 		    
-		double fairness = (throughput_sum * throughput_sum) / (6.0 * throughput_square_sum);
-		datasetFairness.Add(packetSize[j], fairness);
+		result.avgThroughput = throughput_sum / 6.0;
+		result.fairness = (throughput_sum * throughput_sum) / (6.0 * throughput_square_sum);
+		if(dataFlows > 0 && data_throughput_square_sum > 0)
+		{
+			result.metrics["flowmonDataAvgThroughput"] = data_throughput_sum / dataFlows;
+			result.metrics["flowmonDataFairness"] = (data_throughput_sum * data_throughput_sum) / (dataFlows * data_throughput_square_sum);
+		}
+	}
+	else if(sketch)
+	{
+		//top flows, aggregates and delay quantiles of the bounded memory accounting
+		sketch->FillResult(result);
+	}
+	else
+	{
+		//per-flow counters collected from the application traces
+		accounting.FillResult(result);
+	}
+	probe.AddMetrics(result.metrics);
+	if(latency) latency->AddMetrics(result.metrics);
+	if(capture) capture->AddMetrics(result.metrics);
+	if(animation) animation->AddMetrics(result.metrics);
+	if(config.propagationCache)
+	{
+		result.metrics["lossCacheHits"] = channelBS1.lossCache->GetCache().GetHits() + channelBS2.lossCache->GetCache().GetHits();
+		result.metrics["lossCacheMisses"] = channelBS1.lossCache->GetCache().GetMisses() + channelBS2.lossCache->GetCache().GetMisses();
+		result.metrics["cacheInvalidations"] = channelBS1.lossCache->GetCache().GetInvalidations() + channelBS2.lossCache->GetCache().GetInvalidations();
+	}
+	if(channelBS1.grid)
+	{
+		result.metrics["gridRange"] = channelBS1.grid->GetRange();
+		result.metrics["gridDelivered"] = channelBS1.grid->GetDelivered() + channelBS2.grid->GetDelivered();
+		result.metrics["gridCulled"] = channelBS1.grid->GetCulled() + channelBS2.grid->GetCulled();
+	}
+	if(steadyMonitor) steadyMonitor->AddMetrics(result.metrics);
+	result.ok = true;
 
-		std :: cout << "Average Throughput: " << avg_throughput << " Kbps" << std::endl;
-		std :: cout << "FairnessIndex: " << fairness << std::endl;
+	Simulator::Destroy ();
+	return result;
+}
+
+//key of everything the result of a sweep point depends on, including the links, placement and
+//applications of the configuration SimulateWireless is built from. The scheduler and the
+//propagation cache do not change the results and are left out.
+ResultKey GetSweepPointKey(const SweepJob& job, const WirelessConfig& config)
+{
+	ResultKey key;
+	key.Add("program", "wireless");
+	key.Add("apRate", config.apRate).Add("apDelay", config.apDelay).Add("standard", config.standard);
+	key.Add("gridDeltaX", config.gridDeltaX).Add("gridDeltaY", config.gridDeltaY).Add("gridWidth", config.gridWidth);
+	key.Add("appRate", config.appRate).Add("sinkPort", config.sinkPort).Add("sinkStart", config.sinkStart);
+	key.Add("appStart", config.appStart).Add("simStop", config.simStop);
+	key.Add("tcpTypes", std::string(WIRELESS_TCP_TYPES[0]) + "," + WIRELESS_TCP_TYPES[1] + "," + WIRELESS_TCP_TYPES[2]);
+	key.Add("packetSize", job.packetSize).Add("segmentSize", job.packetSize).Add("run", job.run).Add("seed", RngSeedManager::GetSeed());
+	key.Add("nWifi", config.nWifi).Add("accounting", config.accounting).Add("sampleInterval", config.sampleInterval);
+	key.Add("steadyState", config.steadyState);
+	if(config.accounting == "sketch")
+	{
+		key.Add("sketchTopFlows", config.sketchTopFlows).Add("sketchMaxActive", config.sketchMaxActive);
+		key.Add("sketchIdle", config.sketchIdle).Add("sketchAccuracy", config.sketchAccuracy);
+	}
+	if(config.steadyState)
+	{
+		key.Add("steadyWindow", config.steadyWindow).Add("steadyHistory", config.steadyHistory);
+		key.Add("steadyTolerance", config.steadyTolerance).Add("warmup", config.warmup);
+	}
+	key.Add("routing", config.routing).Add("channel", config.channel).Add("rxCutoff", config.rxCutoff);
+	key.Add("linkModel", config.linkModel).Add("mcs", config.mcs).Add("tcpTrace", config.tcpTrace);
+	key.Add("latency", config.latency);
+	if(!config.capture.empty())
+	{
+		key.Add("capture", config.capture).Add("captureOneIn", config.captureOneIn).Add("captureRecords", config.captureRecords);
+		key.Add("captureSnap", config.captureSnap).Add("captureDropBurst", config.captureDropBurst).Add("captureCollapse", config.captureCollapse);
+	}
+	if(config.anim)
+	{
+		key.Add("anim", config.anim).Add("animEvery", config.animEvery).Add("animWindows", config.animWindows).Add("animCompress", config.animCompress);
+	}
+	if(config.linkModel == "fast" && !config.fastTable.empty())
+	{
+		key.AddFile("fastTable", config.fastTable);
+	}
+	return key;
+}
+
+//whether the sweep points write files besides their results (tcp state trace, samples, capture
+//and animation), which a point taken from the result cache does not write again
+bool WritesPointFiles(const WirelessConfig& config)
+{
+	return config.tcpTrace || config.sampleInterval > 0 || !config.capture.empty() || config.anim;
+}
+
+//print the per-flow statistics of one sweep point
+void PrintSweepPoint(const SweepPointResult& result)
+{
+	if(result.flows.empty()) std::cout << "No flow";
+
+	std::cout << "Packet-Size : " << result.packetSize << "\n\n";
+	for(const FlowResult& flow : result.flows)
+	{
+		uint32_t flowID = flow.flowId;
+		if(flowID == 1 || flowID == 2 || flowID == 3) 
+		{	
+			std::cout << "n0 ---> n1\n";
+		}
+		else 
+		{
+			std::cout << "n1 ---> n0\n";
+		}
+		if(!flow.type.empty()) 
+		{	
+			std::cout << "TCP Flow Type : " << flow.type << "\n";
+		}
+		std::cout << "Throughput : " << flow.throughput << " Kbps\n"; 
+		std::cout << "Recevied Bytes : " << flow.rxBytes << "\n"; 
+		std::cout << "Time : " << flow.lastRx - flow.firstTx << " s\n";
+		std::map<std::string, double>::const_iterator delay = result.metrics.find("flowmonDelayMeanMs." + std::to_string(flowID));
+		std::map<std::string, double>::const_iterator jitter = result.metrics.find("flowmonJitterMeanMs." + std::to_string(flowID));
+		if(delay != result.metrics.end()) std::cout << "Mean Delay : " << delay->second << " ms\n";
+		if(jitter != result.metrics.end()) std::cout << "Mean Jitter : " << jitter->second << " ms\n";
+		std::cout << "\n";
+	}
+
+	std :: cout << "Average Throughput: " << result.avgThroughput << " Kbps\n";
+	std :: cout << "FairnessIndex: " << result.fairness << "\n";
+
+	//report when and why the simulation stopped if the convergence monitor was used
+	std::map<std::string, double>::const_iterator stopReason = result.metrics.find("stopReason");
+	if(stopReason != result.metrics.end())
+	{
+		std :: cout << "Stopped at : " << result.metrics.at("stopTime") << " s (" << SteadyStateMonitor::GetStopReasonName(stopReason->second) << ")\n";
+		std :: cout << "Steady-State Average Throughput: " << result.metrics.at("steadyAvgThroughput") << " Kbps\n";
+		std :: cout << "Steady-State FairnessIndex: " << result.metrics.at("steadyFairness") << "\n";
+	}
+	
+	//flow counts and delay quantiles if the sketch accounting was used
+	PrintSketchMetrics(std::cout, result.metrics);
+
+	//delay and jitter percentiles per congestion control and flow if they were recorded
+	PrintLatencyMetrics(std::cout, result.metrics);
     		    
-		std :: cout << "---------------------------------------------------------" << std::endl<< std::endl;
-		//std::cout << "Time Up. Stopped Application\n" ;
-		    	    
-		Simulator::Destroy ();
+	std :: cout << "---------------------------------------------------------\n\n";
+}
+
+//convert a binary tcp state trace to csv, written next to it with a .csv extension
+void ConvertTcpTrace(const std::string& fileName)
+{
+	std::string csvName = fileName.substr(0, fileName.rfind('.')) + ".csv";
+	uint64_t samples = ConvertTcpStateTrace(fileName, csvName);
+	std::cout << "Converted " << samples << " sample(s) to " << csvName << std::endl;
+}
+
+//benchmark comparing the run cost of FlowMonitor and the trace based flow accounting
+void RunAccountingBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WirelessConfig config)
+{
+	std::vector<std::string> names = {"flowmon", "trace", "sketch"};
+	std::vector<std::vector<SweepPointResult> > sweeps;
+	for(const std::string& name : names)
+	{
+		config.accounting = name;
+		sweeps.push_back(RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWireless(job, config); }));
+	}
+	PrintRunComparison(std::cout, names, sweeps);
+}
+
+//benchmark comparing the run cost of computing loss and delay for every receiver and the pairwise cache
+void RunPropagationCacheBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WirelessConfig config)
+{
+	std::vector<std::string> names = {"direct", "cached"};
+	std::vector<std::vector<SweepPointResult> > sweeps;
+	for(const std::string& name : names)
+	{
+		config.propagationCache = name == "cached";
+		sweeps.push_back(RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWireless(job, config); }));
+	}
+	PrintRunComparison(std::cout, names, sweeps);
+}
+
+//benchmark of the events/sec of the yans, spectrum and grid channels as the number of stations per
+//base station grows (1, 10, 100, 500 up to maxStations)
+void RunChannelBenchmark(uint32_t packetSize, uint32_t maxStations, WirelessConfig config)
+{
+	std::vector<uint32_t> stations = {1, 10, 100, 500};
+	std::vector<std::string> channels = {"yans", "spectrum", "grid"};
+	std::cout << "Stations\tChannel\t\tEvents\t\tWall(s)\tEvents/s\tCulled receivers" << std::endl;
+	for(uint32_t nWifi : stations)
+	{
+		if(nWifi > maxStations) break;
+		for(const std::string& channel : channels)
+		{
+			config.nWifi = nWifi;
+			config.channel = channel;
+			SweepPointResult result = SimulateWireless({packetSize, 1}, config);
+			std::cout << nWifi << "\t\t" << channel << "\t\t" << result.metrics["events"] << "\t"
+			          << result.metrics["wallSeconds"] << "\t" << result.metrics["eventsPerSecond"] << "\t"
+			          << result.metrics["gridCulled"] << std::endl;
+		}
+	}
+}
+
+//events/sec of every event scheduler at every packet size
+void RunSchedulerBenchmark(const std::vector<uint32_t>& packetSizes, uint32_t workers, WirelessConfig config)
+{
+	std::vector<std::string> names = GetSchedulerNames();
+	std::vector<std::vector<SweepPointResult> > sweeps;
+	for(const std::string& name : names)
+	{
+		config.scheduler = name;
+		sweeps.push_back(RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWireless(job, config); }));
+	}
+	PrintRunComparison(std::cout, names, sweeps);
+}
+
+//validation of the fast link against the full wifi model over the packet size sweep: throughput
+//and fairness of both models, their relative error and the speedup of the fast link
+void RunFastLinkValidation(const std::vector<uint32_t>& packetSizes, uint32_t workers, WirelessConfig config)
+{
+	config.linkModel = "wifi";
+	std::vector<SweepPointResult> full = RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWireless(job, config); });
+	config.linkModel = "fast";
+	std::vector<SweepPointResult> fast = RunSweep(MakeSweepJobs(packetSizes, 1), workers, [&config](const SweepJob& job) { return SimulateWireless(job, config); });
+
+	std::cout << "Packet-Size\tWifi(Kbps)\tFast(Kbps)\tError\tWifi fairness\tFast fairness\tWifi(s)\tFast(s)\tSpeedup" << std::endl;
+	double errorSum = 0, errorMax = 0;
+	uint32_t points = 0;
+	for(std::size_t i = 0; i < full.size() && i < fast.size(); i++)
+	{
+		if(!full[i].ok || !fast[i].ok) continue;
+		double error = full[i].avgThroughput > 0 ? std::fabs(fast[i].avgThroughput - full[i].avgThroughput) / full[i].avgThroughput : 0;
+		double fullWall = full[i].metrics["wallSeconds"];
+		double fastWall = fast[i].metrics["wallSeconds"];
+		std::cout << full[i].packetSize << "\t\t" << full[i].avgThroughput << "\t\t" << fast[i].avgThroughput << "\t\t"
+		          << error * 100 << "%\t" << full[i].fairness << "\t\t" << fast[i].fairness << "\t\t"
+		          << fullWall << "\t" << fastWall << "\t" << (fastWall > 0 ? fullWall / fastWall : 0) << std::endl;
+		errorSum += error;
+		errorMax = std::max(errorMax, error);
+		points++;
+	}
+	if(points > 0)
+	{
+		std::cout << "Mean throughput error : " << errorSum / points * 100 << "%, max : " << errorMax * 100 << "%" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+
+	//options shared by all sweep points, including the number of wifi devices per base station
+	WirelessConfig config;
+
+	//number of sweep points simulated in parallel, 0 uses one worker per cpu core
+	uint32_t workers = 0;
+
+	//number of replications of every packet size and the relative confidence interval width aimed for
+	uint32_t runs = 1;
+	double ciTarget = 0.05;
+
+	//run the flow accounting benchmark instead of the normal sweep
+	bool accountingBench = false;
+
+	//run the propagation cache benchmark instead of the normal sweep
+	bool cacheBench = false;
+
+	//run the channel benchmark up to this many stations per base station (0 = normal sweep)
+	uint32_t channelBench = 0;
+
+	//compare the fast link with the full wifi model instead of the normal sweep
+	bool validateFast = false;
+
+	//run the scheduler benchmark instead of the normal sweep
+	bool schedulerBench = false;
+
+	//benchmark report written after the sweep, baseline report it is compared with and the
+	//relative slowdown accepted before a sweep point counts as a regression
+	std::string benchReport = "";
+	std::string baseline = "";
+	double regressionThreshold = 0.1;
+
+	//where the per-flow and per-sweep-point results go: console, or a csv/jsonl file named after outputFile
+	std::string output = "console";
+	std::string outputFile = "Wireless-Results";
+
+	//refine the packet sizes adaptively instead of simulating the fixed ones
+	bool adaptive = false;
+	AdaptiveSweepOptions adaptiveOptions;
+
+	//directory of the result cache (empty = always simulate) and whether only cached points are used
+	std::string cacheDir = "";
+	bool cacheOnly = false;
+
+	//binary tcp state trace to convert to csv instead of running the sweep
+	std::string convertTcpTrace = "";
+
+	CommandLine cmd(__FILE__);
+	cmd.AddValue("nWifi", "Number of wifi stations per base station", config.nWifi);
+	cmd.AddValue("workers", "Number of worker processes used for the packet size sweep (0 = one per core, 1 = sequential)", workers);
+	cmd.AddValue("runs", "Number of replications of every packet size with different rng run numbers", runs);
+	cmd.AddValue("ciTarget", "Relative 95% confidence interval width used to estimate the needed replications", ciTarget);
+	cmd.AddValue("accounting", "Flow statistics collection: flowmon (FlowMonitor on all nodes), trace (application traces only) or sketch (bounded memory, top flows and delay quantiles)", config.accounting);
+	cmd.AddValue("sampleInterval", "Interval in seconds of the streamed throughput/fairness time series (0 = disabled)", config.sampleInterval);
+	cmd.AddValue("steadyState", "Stop every sweep point early once the flow throughputs have converged", config.steadyState);
+	cmd.AddValue("steadyWindow", "Throughput window of the convergence monitor in seconds", config.steadyWindow);
+	cmd.AddValue("steadyHistory", "Number of windows compared by the convergence monitor", config.steadyHistory);
+	cmd.AddValue("steadyTolerance", "Relative change of the windowed mean and deviation accepted as converged", config.steadyTolerance);
+	cmd.AddValue("warmup", "Time in seconds before which throughput windows are discarded", config.warmup);
+	cmd.AddValue("capture", "Sample headers of the AP wifi interfaces into a ring dumped to pcap on a drop burst, cwnd collapse or at the end: packets or flows (empty = off)", config.capture);
+	cmd.AddValue("captureOneIn", "Capture one in this many packets (capture=packets) or flows (capture=flows)", config.captureOneIn);
+	cmd.AddValue("captureRecords", "Packets held by the preallocated capture ring", config.captureRecords);
+	cmd.AddValue("captureSnap", "Bytes kept of every captured packet", config.captureSnap);
+	cmd.AddValue("captureDropBurst", "Drops within 100ms that dump the capture ring (0 = no drop trigger)", config.captureDropBurst);
+	cmd.AddValue("captureCollapse", "Dump the capture ring when a cwnd falls below this fraction of its previous value (0 = no cwnd trigger)", config.captureCollapse);
+	cmd.AddValue("anim", "Write a NetAnim trace of every sweep point holding only the packets chosen by animEvery and animWindows", config.anim);
+	cmd.AddValue("animEvery", "Animate every this many packets sent over the links (1 = all)", config.animEvery);
+	cmd.AddValue("animWindows", "Only animate the packets sent within these start-stop windows in seconds, e.g. 10-10.5,12-13 (empty = whole run)", config.animWindows);
+	cmd.AddValue("animCompress", "Pipe the animation through gzip into a .xml.gz file", config.animCompress);
+	cmd.AddValue("animBuffer", "Bytes of animation xml buffered before they are written out", config.animBuffer);
+	cmd.AddValue("latency", "Record one-way delay and jitter percentiles of every flow and congestion control and plot them against the packet size", config.latency);
+	cmd.AddValue("sketchTopFlows", "Flows with the most received bytes listed with exact counters by accounting=sketch", config.sketchTopFlows);
+	cmd.AddValue("sketchMaxActive", "Flows tracked at the same time by accounting=sketch before the least recently active one is folded", config.sketchMaxActive);
+	cmd.AddValue("sketchIdle", "Time in seconds without packets after which accounting=sketch folds a flow into the aggregates, 0 only folds flows beyond sketchMaxActive", config.sketchIdle);
+	cmd.AddValue("sketchAccuracy", "Relative error of the delay and jitter quantiles of accounting=sketch", config.sketchAccuracy);
+	cmd.AddValue("accountingBench", "Only run the benchmark comparing FlowMonitor, trace based and sketch accounting", accountingBench);
+	cmd.AddValue("routing", "Routing of the topology: global, nix (Nix-vector) or static (generated default routes)", config.routing);
+	cmd.AddValue("propagationCache", "Precompute path loss and delay between the static nodes and look them up per packet", config.propagationCache);
+	cmd.AddValue("cacheBench", "Only run the benchmark comparing direct and cached propagation loss and delay", cacheBench);
+	cmd.AddValue("channel", "Wifi channel: yans, spectrum or grid (spectrum channel only delivering frames within range)", config.channel);
+	cmd.AddValue("rxCutoff", "Received power in dBm below which the grid channel does not deliver a frame", config.rxCutoff);
+	cmd.AddValue("channelBench", "Only run the events/sec benchmark of the channels with 1, 10, 100, 500 stations up to this many", channelBench);
+	cmd.AddValue("linkModel", "Model of the wifi links: wifi (full 802.11 model) or fast (table driven abstract link)", config.linkModel);
+	cmd.AddValue("fastTable", "Csv file of mcs,frameBytes,deliveryProbability used by the fast link (empty = no loss)", config.fastTable);
+	cmd.AddValue("mcs", "HT MCS (0 to 7) of the data frames", config.mcs);
+	cmd.AddValue("validateFast", "Only run the validation of the fast link against the full wifi model over the packet sizes", validateFast);
+	cmd.AddValue("scheduler", "Event scheduler: map (default), heap, calendar, list or priority", config.scheduler);
+	cmd.AddValue("schedulerBench", "Only run the benchmark of the events/sec of every scheduler at every packet size", schedulerBench);
+	cmd.AddValue("output", "Result output: console, csv (<outputFile>.meta/points/flows.csv) or jsonl (<outputFile>.jsonl)", output);
+	cmd.AddValue("outputFile", "Prefix of the result files written with output csv or jsonl", outputFile);
+	cmd.AddValue("cacheDir", "Directory of the result cache, sweep points with a cached result are not simulated again", cacheDir);
+	cmd.AddValue("cacheOnly", "Only use the cached sweep points and rebuild the output and plots from them without simulating", cacheOnly);
+	cmd.AddValue("adaptive", "Start from a coarse packet size grid and add sizes where throughput or fairness change sharply or vary between runs", adaptive);
+	cmd.AddValue("adaptiveBudget", "Number of simulations (packet sizes times runs) the adaptive sweep may use", adaptiveOptions.budget);
+	cmd.AddValue("adaptiveCoarse", "Number of log spaced packet sizes of the initial adaptive grid", adaptiveOptions.coarsePoints);
+	cmd.AddValue("adaptiveThreshold", "Relative change or confidence interval width above which an interval is split", adaptiveOptions.threshold);
+	cmd.AddValue("adaptiveMinGap", "Packet size intervals narrower than this many bytes are not split", adaptiveOptions.minGap);
+	cmd.AddValue("minPacketSize", "Smallest packet size of the adaptive sweep", adaptiveOptions.minPacketSize);
+	cmd.AddValue("maxPacketSize", "Largest packet size of the adaptive sweep", adaptiveOptions.maxPacketSize);
+	cmd.AddValue("tcpTrace", "Record cwnd, rtt, ssthresh and congestion state of every flow to <program>-TcpState-<size>-<run>.bin", config.tcpTrace);
+	cmd.AddValue("tcpTraceBuffer", "Samples buffered per flow before the tcp state trace is written out", config.tcpTraceBuffer);
+	cmd.AddValue("convertTcpTrace", "Only convert this binary tcp state trace to csv", convertTcpTrace);
+	cmd.AddValue("benchReport", "Write the wall time, events, events/sec, sim/wall seconds, packets, nodes and peak RSS of every sweep point to this json lines file", benchReport);
+	cmd.AddValue("baseline", "Compare the run cost of the sweep with this benchmark report and exit with 1 on a regression", baseline);
+	cmd.AddValue("regressionThreshold", "Relative growth of wall time or peak RSS (or drop of events/sec) reported as a regression", regressionThreshold);
+	cmd.Parse(argc, argv);
+
+	//declare variables for plotting throughput and fairness
+	std::string graphicsFileName1, graphicsFileNameFairness;
+	std::string plotFileName1, plotFileNameFairness;
+	std::string plotTitle;
+	std::string dataTitle;
+
+	//create datasets for throughput and fairness graphs
+	Gnuplot2dDataset dataset1, datasetFairness;
+	dataTitle = "Throughput";
+    
+	// Instantiate the dataset, set its title, and make the points be
+	// plotted along with connecting lines. 
+	dataset1.SetTitle(dataTitle);
+	dataset1.SetStyle(Gnuplot2dDataset::LINES_POINTS);
+
+	//create filenames for throughput and fairness graphs
+	datasetFairness.SetTitle("Fairness");
+	datasetFairness.SetStyle(Gnuplot2dDataset::LINES_POINTS);
+    
+	//set extensions for filename
+	std::string fileNameWithNoExtension1 = "Wireless-Throughput";
+	std::string fileNameWithNoExtensionFairness = "Wireless-Fairness";
+    
+	graphicsFileName1 = fileNameWithNoExtension1 + ".png";
+	plotFileName1 = fileNameWithNoExtension1 + ".plt";
+	plotTitle = "Throughput Vs Packet Sizes";
+
+	graphicsFileNameFairness = fileNameWithNoExtensionFairness + ".png";
+	plotFileNameFairness = fileNameWithNoExtensionFairness + ".plt";
+   
+	//store packet sizes required in an array
+	uint32_t packetSize[10] = {40, 44, 48, 52, 60, 552, 576, 628, 1420, 1500};
+	std::vector<uint32_t> packetSizes(packetSize, packetSize + 10);
+
+	if(!convertTcpTrace.empty())
+	{
+		ConvertTcpTrace(convertTcpTrace);
+		return 0;
+	}
+	if(accountingBench)
+	{
+		RunAccountingBenchmark(packetSizes, workers, config);
+		return 0;
+	}
+	if(channelBench > 0)
+	{
+		RunChannelBenchmark(packetSizes.back(), channelBench, config);
+		return 0;
+	}
+	if(cacheBench)
+	{
+		RunPropagationCacheBenchmark(packetSizes, workers, config);
+		return 0;
+	}
+	if(schedulerBench)
+	{
+		RunSchedulerBenchmark(packetSizes, workers, config);
+		return 0;
+	}
+	if(validateFast)
+	{
+		RunFastLinkValidation(packetSizes, workers, config);
+		return 0;
+	}
+	std :: cout << "---------------------------------------------------------" << std::endl<< std::endl;
+
+	//simulate every packet size and replication, each one in its own worker process
+	//points found in the result cache are not simulated again
+	SweepFunction simulate = [&config](const SweepJob& job) { return SimulateWireless(job, config); };
+	if(!cacheDir.empty() && WritesPointFiles(config))
+	{
+		if(cacheOnly)
+		{
+			std :: cout << "Result cache : the per-point files of cached points are not written again\n";
+		}
+		else
+		{
+			std :: cout << "Result cache : not used, the sweep points write per-point files\n";
+			cacheDir = "";
+		}
+	}
+	std::unique_ptr<ResultCache> cache;
+	if(!cacheDir.empty())
+	{
+		cache.reset(new ResultCache(cacheDir));
+	}
+	SweepBatchFunction simulateBatch = [&](const std::vector<SweepJob>& jobs)
+	{
+		if(cache) return RunCachedSweep(jobs, workers, simulate, *cache, [&config](const SweepJob& job) { return GetSweepPointKey(job, config); }, cacheOnly);
+		return RunSweep(jobs, workers, simulate);
+	};
+
+	//either the fixed packet sizes or an adaptive sweep refining where the curves change
+	std::vector<SweepPointResult> results = adaptive ? RunAdaptiveSweep(adaptiveOptions, runs, simulateBatch) : simulateBatch(MakeSweepJobs(packetSizes, runs));
+	if(cache)
+	{
+		std :: cout << "Result cache : " << cache->GetHits() << " hit(s), " << cache->GetMisses() << " miss(es)" << (cacheOnly ? ", misses not simulated" : "") << "\n";
+		if(!benchReport.empty() || !baseline.empty()) std :: cout << "Cached points are left out of the benchmark report and the baseline comparison\n";
+		std :: cout << "\n";
+	}
+
+	//buffer the records of the sweep, they are written in one go and feed the plots
+	ResultWriter writer;
+	writer.AddMetadata("program", "wireless");
+	writer.AddMetadata("runs", std::to_string(runs));
+	writer.AddMetadata("workers", std::to_string(workers));
+	writer.AddMetadata("routing", config.routing);
+	writer.AddMetadata("scheduler", config.scheduler);
+	writer.AddMetadata("accounting", config.accounting);
+	writer.AddMetadata("nWifi", std::to_string(config.nWifi));
+	writer.AddMetadata("channel", config.channel);
+	writer.AddMetadata("linkModel", config.linkModel);
+	writer.AddPoints(results);
+	if(output != "console")
+	{
+		writer.SetFormat(output);
+		writer.Write(outputFile);
+	}
+
+	//machine readable run cost of the sweep and its comparison with a stored baseline
+	std::string benchMode = "wireless";
+	if(!benchReport.empty())
+	{
+		WriteBenchmarkReport(benchReport, benchMode, results);
+	}
+	uint32_t regressions = 0;
+	if(!baseline.empty())
+	{
+		regressions = CompareWithBaseline(std::cout, ReadBenchmarkReport(baseline), benchMode, results, regressionThreshold);
+		std :: cout << std::endl;
+	}
+
+	if(runs == 1)
+	{
+		//print the statistics unless they go to a file, and plot the same records in packet size order
+		if(output == "console")
+		{
+			for(const SweepPointResult& result : writer.GetPoints())
+			{
+				PrintSweepPoint(result);
+			}
+			std::cout.flush();
+		}
+		writer.FillDataset(dataset1, "avgThroughput");
+		writer.FillDataset(datasetFairness, "fairness");
+	}
+	else
+	{
+		//print the outcome of every replication
+		for(const SweepPointResult& result : results)
+		{
+			if(!result.ok) continue;
+			std::cout << "Packet-Size : " << result.packetSize << " Run : " << result.run
+			          << " Average Throughput: " << result.avgThroughput << " Kbps"
+			          << " FairnessIndex: " << result.fairness << "\n";
+		}
+		std :: cout << std::endl;
+
+		//plot the mean of the replications with the 95% confidence interval as error bars
+		dataset1.SetErrorBars(Gnuplot2dDataset::Y);
+		datasetFairness.SetErrorBars(Gnuplot2dDataset::Y);
+		for(const ReplicationSummary& summary : SummarizeReplications(results))
+		{
+			PrintReplicationSummary(std::cout, summary, ciTarget);
+			dataset1.Add(summary.packetSize, summary.throughput.mean, summary.throughput.ciHalfWidth);
+			datasetFairness.Add(summary.packetSize, summary.fairness.mean, summary.fairness.ciHalfWidth);
+		}
 	}
   
 	// Instantiate the plot and set its title.
@@ -382,5 +1211,11 @@ int main(int argc, char* argv[])
 
 	// Close the plot file.
 	plotFile4.close();
-	return 0;
+
+	//p50 and p99 one-way delay of every congestion control against the packet size
+	if(config.latency)
+	{
+		WriteLatencyPlot(writer, "Wireless-Latency");
+	}
+	return regressions > 0 ? 1 : 0;
 }